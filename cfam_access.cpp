@@ -15,14 +15,24 @@
  */
 #include "cfam_access.hpp"
 
+#include "p10_cfam.hpp"
+#include "p9_cfam.hpp"
 #include "targeting.hpp"
+#include "timing.hpp"
 
+#include <endian.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <xyz/openbmc_project/Common/Device/error.hpp>
-#include <xyz/openbmc_project/Common/File/error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <span>
+#include <vector>
 
 namespace openpower
 {
@@ -35,7 +45,6 @@ constexpr auto cfamRegSize = 4;
 
 using namespace openpower::targeting;
 using namespace openpower::util;
-namespace file_error = sdbusplus::xyz::openbmc_project::Common::File::Error;
 namespace device_error = sdbusplus::xyz::openbmc_project::Common::Device::Error;
 
 /**
@@ -48,81 +57,287 @@ static inline cfam_address_t makeOffset(cfam_address_t address)
     return (address & 0xFC00) | ((address & 0x03FF) << 2);
 }
 
-void writeReg(const std::unique_ptr<Target>& target, cfam_address_t address,
-              cfam_data_t data)
+/**
+ * Returns true if the next register after the one at the passed in
+ * address lives at the next offset in the device, so the two can be
+ * accessed with a single vectored call.
+ */
+static inline bool isContiguous(cfam_address_t address, cfam_address_t next)
+{
+    return makeOffset(next) == makeOffset(address) + cfamRegSize;
+}
+
+/**
+ * Returns true if the register can change underneath us, so it
+ * must always be read from the hardware.
+ */
+static bool isVolatile(cfam_address_t address)
+{
+    auto contains = [address](const auto& regs) {
+        return std::ranges::find(regs, address) != regs.end();
+    };
+
+    return contains(openpower::cfam::p9::P9_VOLATILE_REGS) ||
+           contains(openpower::cfam::p10::P10_VOLATILE_REGS);
+}
+
+/**
+ * Records the values of the registers at 'addresses' in the target's
+ * shadow register cache, if enabled.
+ */
+static void updateShadowRegs(Target& target,
+                             std::span<const cfam_address_t> addresses,
+                             const cfam_data_t* data)
 {
-    using namespace phosphor::logging;
-    int rc = lseek(target->getCFAMFD(), makeOffset(address), SEEK_SET);
-    if (rc < 0)
+    if (!target.isShadowing())
     {
-        log<level::ERR>("Failed seeking on a processor CFAM",
-                        entry("CFAM_ADDRESS=0x%X", address));
+        return;
+    }
 
-        using metadata = xyz::openbmc_project::Common::File::Seek;
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        if (!isVolatile(addresses[i]))
+        {
+            target.setShadowReg(addresses[i], data[i]);
+        }
+    }
+}
+
+/**
+ * Writes the registers at 'addresses', which must be contiguous in
+ * the device, see isContiguous().  The data is passed in host byte
+ * order.
+ */
+static void writeRegs(Target& target, std::span<const cfam_address_t> addresses,
+                      const cfam_data_t* data)
+{
+    timing::Span span{"CFAM write"};
+    auto address = addresses.front();
+    auto count = addresses.size();
+    ssize_t rc = 0;
 
-        elog<file_error::Seek>(metadata::OFFSET(makeOffset(address)),
-                               metadata::WHENCE(SEEK_SET),
-                               metadata::ERRNO(errno),
-                               metadata::PATH(target->getCFAMPath().c_str()));
+    if (count == 1)
+    {
+        cfam_data_t buffer = htobe32(*data);
+        rc = pwrite(target.getCFAMFD(), &buffer, cfamRegSize,
+                    makeOffset(address));
     }
+    else
+    {
+        std::vector<cfam_data_t> buffer(data, data + count);
+        std::vector<iovec> iov(count);
 
-    data = htobe32(data);
+        for (size_t i = 0; i < count; i++)
+        {
+            buffer[i] = htobe32(buffer[i]);
+            iov[i].iov_base = &buffer[i];
+            iov[i].iov_len = cfamRegSize;
+        }
 
-    rc = write(target->getCFAMFD(), &data, cfamRegSize);
-    if (rc < 0)
+        rc = pwritev(target.getCFAMFD(), iov.data(), iov.size(),
+                     makeOffset(address));
+    }
+
+    if (rc != static_cast<ssize_t>(count * cfamRegSize))
     {
+        using namespace phosphor::logging;
         using metadata = xyz::openbmc_project::Common::Device::WriteFailure;
 
+        // A short transfer doesn't set errno
+        int err = (rc < 0) ? errno : EIO;
+
+        log<level::ERR>("Failed writing a processor CFAM",
+                        entry("CFAM_ADDRESS=0x%X", address));
+
         elog<device_error::WriteFailure>(
-            metadata::CALLOUT_ERRNO(errno),
-            metadata::CALLOUT_DEVICE_PATH(target->getCFAMPath().c_str()));
+            metadata::CALLOUT_ERRNO(err),
+            metadata::CALLOUT_DEVICE_PATH(target.getCFAMPath().c_str()));
     }
+
+    updateShadowRegs(target, addresses, data);
 }
 
-cfam_data_t readReg(const std::unique_ptr<Target>& target,
-                    cfam_address_t address)
+/**
+ * Reads the registers at 'addresses', which must be contiguous in
+ * the device, see isContiguous().  The data is returned in host byte
+ * order.
+ */
+static void readRegs(Target& target, std::span<const cfam_address_t> addresses,
+                     cfam_data_t* data)
 {
-    using namespace phosphor::logging;
+    timing::Span span{"CFAM read"};
+    auto address = addresses.front();
+    auto count = addresses.size();
+    ssize_t rc = 0;
 
-    cfam_data_t data = 0;
-
-    int rc = lseek(target->getCFAMFD(), makeOffset(address), SEEK_SET);
-    if (rc < 0)
+    if (count == 1)
     {
-        log<level::ERR>("Failed seeking on a processor CFAM",
-                        entry("CFAM_ADDRESS=0x%X", address));
+        rc = pread(target.getCFAMFD(), data, cfamRegSize, makeOffset(address));
+    }
+    else
+    {
+        std::vector<iovec> iov(count);
 
-        using metadata = xyz::openbmc_project::Common::File::Seek;
+        for (size_t i = 0; i < count; i++)
+        {
+            iov[i].iov_base = &data[i];
+            iov[i].iov_len = cfamRegSize;
+        }
 
-        elog<file_error::Seek>(metadata::OFFSET(makeOffset(address)),
-                               metadata::WHENCE(SEEK_SET),
-                               metadata::ERRNO(errno),
-                               metadata::PATH(target->getCFAMPath().c_str()));
+        rc = preadv(target.getCFAMFD(), iov.data(), iov.size(),
+                    makeOffset(address));
     }
 
-    rc = read(target->getCFAMFD(), &data, cfamRegSize);
-    if (rc < 0)
+    if (rc != static_cast<ssize_t>(count * cfamRegSize))
     {
+        using namespace phosphor::logging;
         using metadata = xyz::openbmc_project::Common::Device::ReadFailure;
 
+        // A short transfer doesn't set errno
+        int err = (rc < 0) ? errno : EIO;
+
+        log<level::ERR>("Failed reading a processor CFAM",
+                        entry("CFAM_ADDRESS=0x%X", address));
+
         elog<device_error::ReadFailure>(
-            metadata::CALLOUT_ERRNO(errno),
-            metadata::CALLOUT_DEVICE_PATH(target->getCFAMPath().c_str()));
+            metadata::CALLOUT_ERRNO(err),
+            metadata::CALLOUT_DEVICE_PATH(target.getCFAMPath().c_str()));
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        data[i] = be32toh(data[i]);
     }
 
-    return be32toh(data);
+    updateShadowRegs(target, addresses, data);
 }
 
-void writeRegWithMask(const std::unique_ptr<Target>& target,
-                      cfam_address_t address, cfam_data_t data,
-                      cfam_mask_t mask)
+/**
+ * Returns the current value of a register that is about to be updated
+ * with a masked write.  The shadow register cache is used when possible
+ * to avoid the hardware read.
+ */
+static cfam_data_t readForUpdate(Target& target, cfam_address_t address)
+{
+    if (!isVolatile(address))
+    {
+        if (auto data = target.getShadowReg(address))
+        {
+            return *data;
+        }
+    }
+
+    cfam_data_t data = 0;
+    readRegs(target, {&address, 1}, &data);
+
+    return data;
+}
+
+void writeReg(Target& target, cfam_address_t address, cfam_data_t data)
+{
+    writeRegs(target, {&address, 1}, &data);
+}
+
+cfam_data_t readReg(Target& target, cfam_address_t address)
 {
-    cfam_data_t readData = readReg(target, address);
+    cfam_data_t data = 0;
+
+    readRegs(target, {&address, 1}, &data);
+
+    return data;
+}
+
+void writeRegWithMask(Target& target, cfam_address_t address,
+                      cfam_data_t data, cfam_mask_t mask)
+{
+    cfam_data_t readData = readForUpdate(target, address);
 
     readData &= ~mask;
     readData |= (data & mask);
 
-    writeReg(target, address, readData);
+    writeRegs(target, {&address, 1}, &readData);
+}
+
+Transaction& Transaction::read(cfam_address_t address)
+{
+    requests.push_back({Op::read, address, 0, 0});
+    return *this;
+}
+
+Transaction& Transaction::write(cfam_address_t address, cfam_data_t data)
+{
+    requests.push_back({Op::write, address, data, 0});
+    return *this;
+}
+
+Transaction& Transaction::writeWithMask(cfam_address_t address,
+                                        cfam_data_t data, cfam_mask_t mask)
+{
+    requests.push_back({Op::writeWithMask, address, data, mask});
+    return *this;
+}
+
+std::vector<cfam_data_t> Transaction::submit()
+{
+    std::vector<cfam_data_t> results;
+    std::vector<cfam_address_t> addresses;
+    std::vector<cfam_data_t> data;
+
+    // Clear the queue even if one of the operations throws
+    auto pending = std::move(requests);
+    requests.clear();
+
+    size_t i = 0;
+    while (i < pending.size())
+    {
+        const auto& first = pending[i];
+
+        if (first.op == Op::writeWithMask)
+        {
+            cfam_data_t readData = readForUpdate(*target, first.address);
+
+            readData &= ~first.mask;
+            readData |= (first.data & first.mask);
+
+            writeRegs(*target, {&first.address, 1}, &readData);
+            i++;
+            continue;
+        }
+
+        // Find the run of the same operation on consecutive registers
+        size_t count = 1;
+        while ((i + count < pending.size()) && (count < IOV_MAX) &&
+               (pending[i + count].op == first.op) &&
+               isContiguous(pending[i + count - 1].address,
+                            pending[i + count].address))
+        {
+            count++;
+        }
+
+        // The addresses of a run aren't consecutive across a 0x400
+        // boundary, so pass them all on.
+        addresses.resize(count);
+        data.resize(count);
+        for (size_t j = 0; j < count; j++)
+        {
+            addresses[j] = pending[i + j].address;
+            data[j] = pending[i + j].data;
+        }
+
+        if (first.op == Op::read)
+        {
+            readRegs(*target, addresses, data.data());
+            results.insert(results.end(), data.begin(), data.end());
+        }
+        else
+        {
+            writeRegs(*target, addresses, data.data());
+        }
+
+        i += count;
+    }
+
+    return results;
 }
 
 } // namespace access
@@ -3,7 +3,7 @@
 #include "targeting.hpp"
 
 #include <cstdint>
-#include <memory>
+#include <vector>
 
 namespace openpower
 {
@@ -25,8 +25,8 @@ using cfam_mask_t = uint32_t;
  * @param[in] address - The register address to write to
  * @param[in] data - The data to write
  */
-void writeReg(const std::unique_ptr<openpower::targeting::Target>& target,
-              cfam_address_t address, cfam_data_t data);
+void writeReg(openpower::targeting::Target& target, cfam_address_t address,
+              cfam_data_t data);
 
 /**
  * @brief Reads a CFAM (Common FRU Access Macro) register in a P9.
@@ -37,7 +37,7 @@ void writeReg(const std::unique_ptr<openpower::targeting::Target>& target,
  * @param[in] address - The register address to read
  * @return - The register data
  */
-cfam_data_t readReg(const std::unique_ptr<openpower::targeting::Target>& target,
+cfam_data_t readReg(openpower::targeting::Target& target,
                     cfam_address_t address);
 
 /**
@@ -46,6 +46,9 @@ cfam_data_t readReg(const std::unique_ptr<openpower::targeting::Target>& target,
  *
  * Only bits that are set in the mask parameter will be modified.
  *
+ * If shadowing is enabled on the target, the last known value of a
+ * non-volatile register is used instead of reading it from the hardware.
+ *
  * Throws an exception on error.
  *
  * @param[in] target - The Target to perform the operation on
@@ -53,9 +56,112 @@ cfam_data_t readReg(const std::unique_ptr<openpower::targeting::Target>& target,
  * @param[in] data - The data to write
  * @param[in] mask - The mask
  */
-void writeRegWithMask(
-    const std::unique_ptr<openpower::targeting::Target>& target,
-    cfam_address_t address, cfam_data_t data, cfam_mask_t mask);
+void writeRegWithMask(openpower::targeting::Target& target,
+                      cfam_address_t address, cfam_data_t data,
+                      cfam_mask_t mask);
+
+/**
+ * @class Transaction
+ *
+ * Queues up CFAM register reads, writes and masked writes against a
+ * single Target and then submits them all at once.
+ *
+ * Operations are executed in the order they were queued.  Runs of reads
+ * or writes to consecutive registers are coalesced into a single
+ * preadv/pwritev call, and every access is done with an explicit offset
+ * so no separate seek is needed.  Masked writes use the target's shadow
+ * register cache the same way writeRegWithMask does.
+ *
+ * Throws an exception on error, in which case the operations queued
+ * after the failing one are not executed.
+ */
+class Transaction
+{
+  public:
+    Transaction() = delete;
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+    Transaction(Transaction&&) = default;
+    Transaction& operator=(Transaction&&) = default;
+    ~Transaction() = default;
+
+    /**
+     * Constructor
+     *
+     * @param[in] target - The Target to perform the operations on
+     */
+    explicit Transaction(openpower::targeting::Target& target) :
+        target(&target)
+    {}
+
+    /**
+     * @brief Queues a register read.
+     *
+     * @param[in] address - The register address to read
+     * @return - This transaction
+     */
+    Transaction& read(cfam_address_t address);
+
+    /**
+     * @brief Queues a register write.
+     *
+     * @param[in] address - The register address to write to
+     * @param[in] data - The data to write
+     * @return - This transaction
+     */
+    Transaction& write(cfam_address_t address, cfam_data_t data);
+
+    /**
+     * @brief Queues a register write of only the bits set in the mask.
+     *
+     * @param[in] address - The register address to write to
+     * @param[in] data - The data to write
+     * @param[in] mask - The mask
+     * @return - This transaction
+     */
+    Transaction& writeWithMask(cfam_address_t address, cfam_data_t data,
+                               cfam_mask_t mask);
+
+    /**
+     * @brief Executes all of the queued operations and clears the queue.
+     *
+     * @return - The data of each queued read, in the order they were queued
+     */
+    std::vector<cfam_data_t> submit();
+
+  private:
+    /**
+     * The kinds of operations that can be queued
+     */
+    enum class Op
+    {
+        read,
+        write,
+        writeWithMask
+    };
+
+    /**
+     * A single queued operation
+     */
+    struct Request
+    {
+        Op op;
+        cfam_address_t address;
+        cfam_data_t data;
+        cfam_mask_t mask;
+    };
+
+    /**
+     * The Target to perform the operations on
+     */
+    openpower::targeting::Target* target;
+
+    /**
+     * The queued operations
+     */
+    std::vector<Request> requests;
+};
+
 } // namespace access
 } // namespace cfam
 } // namespace openpower
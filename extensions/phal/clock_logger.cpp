@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 
+#include "config.h"
+
 #include "extensions/phal/clock_logger.hpp"
 
+#include "extensions/phal/clock_snapshot.hpp"
+#include "extensions/phal/pdbg_utils.hpp"
 #include "util.hpp"
 
 #include <attributes_info.H>
@@ -25,7 +29,12 @@
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/utility/timer.hpp>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
 
 using namespace openpower::pel;
 
@@ -33,10 +42,12 @@ PHOSPHOR_LOG2_USING;
 
 namespace openpower::phal::clock
 {
-constexpr auto CLOCK_DAILY_LOGGER_TIMEOUT_IN_HOUR = 24;
 
 Manager::Manager(const sdeventplus::Event& event) :
-    _event(event), timer(event, std::bind(&Manager::timerExpired, this))
+    _event(event), config(loadSamplingConfig(CLOCK_SAMPLING_CONFIG_FILE)),
+    sampler(config.groups, Sampler::Clock::now(), collectSample),
+    nextLog(Sampler::Clock::now() + config.logPeriod),
+    timer(event, std::bind(&Manager::timerExpired, this))
 
 {
     try
@@ -44,6 +55,9 @@ Manager::Manager(const sdeventplus::Event& event) :
         // pdbg initialisation
         openpower::phal::pdbg::init();
 
+        // Take the first samples, so the log has a baseline
+        sampler.run(Sampler::Clock::now());
+
         // Create clock data log.
         createClockDataLog();
     }
@@ -57,23 +71,50 @@ Manager::Manager(const sdeventplus::Event& event) :
 
 void Manager::addTimer()
 {
-    // Set timer for 24 hours.
-    timer.restart(std::chrono::hours(CLOCK_DAILY_LOGGER_TIMEOUT_IN_HOUR));
+    // One timer serves every sample group and the log.  It fires at
+    // the latest time any of them can run, and then runs everything
+    // that is due, so groups with jitter share wakeups.
+    auto now = Sampler::Clock::now();
+    auto wakeup = std::min(nextLog, sampler.getWakeup());
+    auto timeout = std::max(wakeup - now, Sampler::Clock::duration::zero());
+
+    timer.restartOnce(std::chrono::duration_cast<Timer::Duration>(timeout));
 }
 
 void Manager::timerExpired()
 {
-    info("Clock daily logging started");
+    auto now = Sampler::Clock::now();
+
+    // The FSI devices may have been rescanned since the last wakeup
+    releaseProcHandles();
 
     try
     {
-        // Create clock data log.
-        createClockDataLog();
+        sampler.run(now);
     }
     catch (const std::exception& e)
     {
-        error("createClockDataLog exception ({ERROR})", "ERROR", e);
+        error("Clock sampling exception ({ERROR})", "ERROR", e);
     }
+
+    if (now >= nextLog)
+    {
+        info("Clock daily logging started");
+
+        try
+        {
+            // Create clock data log.
+            createClockDataLog();
+        }
+        catch (const std::exception& e)
+        {
+            error("createClockDataLog exception ({ERROR})", "ERROR", e);
+        }
+
+        nextLog = now + config.logPeriod;
+    }
+
+    addTimer();
 }
 
 void Manager::createClockDataLog()
@@ -144,33 +185,92 @@ void Manager::createClockDataLog()
     }
 
     // Add clock register information
-    addClockRegData(clockDataLog);
+    FFDCSections clockRegSections;
+    addClockRegData(clockDataLog, clockRegSections);
+
+    // Only create the full log if something changed since the last
+    // one, or it is getting old, and a heartbeat otherwise.
+    Snapshot current{clockDataLog, clockRegSections};
+    auto previous = Snapshot::load(CLOCK_LOG_SNAPSHOT_FILE);
+    uint64_t now = time(nullptr);
+
+    // Sampled groups are compared as they are sampled, so they are
+    // kept out of the snapshot and only added to the full log.
+    auto changes = sampler.takeChanges();
+    bool full = true;
+    if (previous)
+    {
+        auto diff = current.diff(*previous);
+        changes.insert(changes.end(), diff.begin(), diff.end());
+        auto last = previous->getFullLogTime();
+        uint64_t interval =
+            static_cast<uint64_t>(CLOCK_LOG_FULL_INTERVAL_DAYS) * 24 * 60 * 60;
+        full = !changes.empty() || (now < last) || (now - last >= interval);
+    }
 
-    openpower::pel::createPEL("org.open_power.PHAL.Info.ClockDailyLog",
-                              clockDataLog, Severity::Informational);
+    if (full)
+    {
+        if (!changes.empty())
+        {
+            std::string changed;
+            for (const auto& change : changes)
+            {
+                changed += (changed.empty() ? "" : ", ") + change;
+            }
+            clockDataLog.emplace_back("Changed", changed);
+        }
+
+        for (auto& section : sampler.getSections())
+        {
+            clockRegSections.push_back(std::move(section));
+        }
+
+        openpower::pel::createPEL("org.open_power.PHAL.Info.ClockDailyLog",
+                                  clockDataLog, Severity::Informational,
+                                  clockRegSections);
+        current.setFullLogTime(now);
+    }
+    else
+    {
+        time_t last = previous->getFullLogTime();
+        char timeBuf[80];
+        tm lastTm{};
+        gmtime_r(&last, &lastTm);
+        strftime(timeBuf, sizeof(timeBuf), "%Y-%m-%d %H:%M:%S", &lastTm);
+
+        openpower::pel::createPEL(
+            "org.open_power.PHAL.Info.ClockDailyLog",
+            {{"Heartbeat", std::string("No change since ") + timeBuf}},
+            Severity::Informational);
+        current.setFullLogTime(previous->getFullLogTime());
+    }
+
+    current.save(CLOCK_LOG_SNAPSHOT_FILE);
 }
 
 void Manager::addCFAMData(struct pdbg_target* proc,
                           openpower::pel::FFDCData& clockDataLog)
 {
     // collect Processor CFAM register data
-    const std::vector<int> procCFAMAddr = {
+    static constexpr std::array<uint32_t, 9> procCFAMAddr = {
         0x1007, 0x2804, 0x2810, 0x2813, 0x2814, 0x2815, 0x2816, 0x281D, 0x281E};
 
     auto index = std::to_string(pdbg_target_index(proc));
 
-    for (int addr : procCFAMAddr)
+    // The processor's targets are only looked up and probed once.  A
+    // register that can't be read shows as failedCFAMValue.
+    std::vector<uint32_t> vals;
+    auto rc = openpower::phal::getCFAMs(proc, procCFAMAddr, vals);
+    if (rc)
     {
-        auto val = 0xDEADBEEF;
-        try
-        {
-            val = openpower::phal::pdbg::getCFAM(proc, addr);
-        }
-        catch (const std::exception& e)
-        {
-            error("getCFAM on {TARGET} thrown exception({ERROR}): Addr ({REG})",
-                  "TARGET", pdbg_target_path(proc), "ERROR", e, "REG", addr);
-        }
+        error("getCFAMs on {TARGET} failed({RC})", "TARGET",
+              pdbg_target_path(proc), "RC", rc);
+    }
+
+    for (size_t i = 0; i < procCFAMAddr.size(); i++)
+    {
+        auto addr = procCFAMAddr[i];
+        auto val = vals[i];
         std::stringstream ssData;
         ssData << "0x" << std::setfill('0') << std::setw(8) << std::hex << val;
         std::stringstream ssAddr;
@@ -180,7 +280,128 @@ void Manager::addCFAMData(struct pdbg_target* proc,
     }
 }
 
-void Manager::addClockRegData(openpower::pel::FFDCData& clockDataLog)
+size_t readClockRegs(struct pdbg_target* clockTarget, ClockRegs& regs)
+{
+    regs.fill(0xFF);
+
+    if (!i2c_read(clockTarget, 0, 0, regs.size(), regs.data()))
+    {
+        return regs.size();
+    }
+
+    // Retry in chunks, to keep what can be read
+    constexpr auto I2C_READ_SIZE = 0x08;
+    size_t count = 0;
+
+    for (size_t addr = 0; addr < regs.size(); addr += I2C_READ_SIZE)
+    {
+        auto i2cRc = i2c_read(clockTarget, 0, addr, I2C_READ_SIZE,
+                              regs.data() + addr);
+        if (i2cRc)
+        {
+            error("({TARGET}) I2C read error({ERROR}) reported {ADDRESS} ",
+                  "TARGET", pdbg_target_path(clockTarget), "ERROR", i2cRc,
+                  "ADDRESS", addr);
+            std::fill_n(regs.begin() + addr, I2C_READ_SIZE, 0xFF);
+            continue;
+        }
+        count += I2C_READ_SIZE;
+    }
+
+    return count;
+}
+
+std::vector<uint8_t> collectSample(const SampleGroup& group)
+{
+    std::vector<uint8_t> values;
+
+    if (!group.cfam.empty())
+    {
+        struct pdbg_target* procTarget;
+        ATTR_HWAS_STATE_Type hwasState;
+        pdbg_for_each_class_target("proc", procTarget)
+        {
+            if (DT_GET_PROP(ATTR_HWAS_STATE, procTarget, hwasState) ||
+                !hwasState.functional)
+            {
+                continue;
+            }
+
+            std::vector<uint32_t> vals;
+            getCFAMs(procTarget, group.cfam, vals);
+            for (auto val : vals)
+            {
+                values.push_back(static_cast<uint8_t>(val >> 24));
+                values.push_back(static_cast<uint8_t>(val >> 16));
+                values.push_back(static_cast<uint8_t>(val >> 8));
+                values.push_back(static_cast<uint8_t>(val));
+            }
+        }
+    }
+
+    if (!group.i2c.empty())
+    {
+        struct pdbg_target* clockTarget;
+        ATTR_HWAS_STATE_Type hwasState;
+        pdbg_for_each_class_target("oscrefclk", clockTarget)
+        {
+            if (DT_GET_PROP(ATTR_HWAS_STATE, clockTarget, hwasState) ||
+                !hwasState.present ||
+                pdbg_target_probe(clockTarget) != PDBG_TARGET_ENABLED)
+            {
+                continue;
+            }
+
+            for (const auto& range : group.i2c)
+            {
+                auto start = values.size();
+                values.resize(start + range.size, 0xFF);
+                if (i2c_read(clockTarget, 0, range.offset, range.size,
+                             values.data() + start))
+                {
+                    std::fill(values.begin() + start, values.end(), 0xFF);
+                }
+            }
+        }
+    }
+
+    return values;
+}
+
+std::string formatClockRegs(const ClockRegs& regs)
+{
+    constexpr auto digits = "0123456789abcdef";
+    constexpr size_t perLine = 16;
+    // "aa:" then " xx" for each register and a newline
+    constexpr size_t lineSize = 3 + (3 * perLine) + 1;
+
+    std::string text(lineSize * (regs.size() / perLine), ' ');
+    auto out = text.begin();
+
+    for (size_t addr = 0; addr < regs.size(); addr++)
+    {
+        if (addr % perLine == 0)
+        {
+            *out++ = digits[addr >> 4];
+            *out++ = digits[addr & 0xF];
+            *out++ = ':';
+        }
+
+        *out++ = ' ';
+        *out++ = digits[regs[addr] >> 4];
+        *out++ = digits[regs[addr] & 0xF];
+
+        if (addr % perLine == perLine - 1)
+        {
+            *out++ = '\n';
+        }
+    }
+
+    return text;
+}
+
+void Manager::addClockRegData(openpower::pel::FFDCData& clockDataLog,
+                              openpower::pel::FFDCSections& ffdcSections)
 {
     info("Adding clock register information to daily logger");
 
@@ -207,7 +428,8 @@ void Manager::addClockRegData(openpower::pel::FFDCData& clockDataLog)
             funState = "Functional";
         }
 
-        auto index = std::to_string(pdbg_target_index(clockTarget));
+        auto clockIndex = pdbg_target_index(clockTarget);
+        auto index = std::to_string(clockIndex);
 
         std::stringstream ssState;
         ssState << "Clock" << index;
@@ -225,34 +447,27 @@ void Manager::addClockRegData(openpower::pel::FFDCData& clockDataLog)
             continue;
         }
 
-        // Update Buffer with clock I2C register data.
-        auto constexpr I2C_READ_SIZE = 0x08;
-        auto constexpr I2C_ADDR_MAX = 0xFF;
-
-        for (auto addr = 0; addr <= I2C_ADDR_MAX; addr += I2C_READ_SIZE)
+        // Add the clock I2C register image as binary FFDC
+        ClockRegs regs;
+        auto count = readClockRegs(clockTarget, regs);
+        if (count != regs.size())
         {
-            std::stringstream ssData;
+            clockDataLog.push_back(
+                std::make_pair("Clock" + index + " regs read",
+                               std::to_string(count) + "/" +
+                                   std::to_string(regs.size())));
+        }
 
-            uint8_t data[0x8];
-            auto i2cRc = i2c_read(clockTarget, 0, addr, I2C_READ_SIZE, data);
-            if (i2cRc)
-            {
-                error("({TARGET}) I2C read error({ERROR}) reported {ADDRESS} ",
-                      "TARGET", pdbg_target_path(clockTarget), "ERROR", i2cRc,
-                      "ADDRESS", addr);
-                continue;
-            }
+        debug("Clock{INDEX} registers:\n{REGS}", "INDEX", clockIndex, "REGS",
+              formatClockRegs(regs));
 
-            for (auto i = 0; i < I2C_READ_SIZE; i++)
-            {
-                ssData << " " << std::hex << std::setfill('0') << std::setw(2)
-                       << (uint16_t)data[i];
-            }
-            std::stringstream ssAddr;
-            ssAddr << "Clock" << index << "_0x" << std::hex << std::setfill('0')
-                   << std::setw(2) << addr;
-            clockDataLog.push_back(make_pair(ssAddr.str(), ssData.str()));
-        }
+        std::vector<uint8_t> data{static_cast<uint8_t>(clockIndex >> 24),
+                                  static_cast<uint8_t>(clockIndex >> 16),
+                                  static_cast<uint8_t>(clockIndex >> 8),
+                                  static_cast<uint8_t>(clockIndex)};
+        data.insert(data.end(), regs.begin(), regs.end());
+        ffdcSections.push_back({openpower::pel::clockRegsSubType, 1,
+                                std::move(data)});
     }
 }
 
@@ -15,11 +15,17 @@
  */
 #pragma once
 
+#include "extensions/phal/clock_sampler.hpp"
 #include "extensions/phal/create_pel.hpp"
 
 #include <sdeventplus/utility/timer.hpp>
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace openpower::phal::clock
 {
@@ -27,6 +33,47 @@ namespace openpower::phal::clock
 /* Dbus event timer */
 using Timer = sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>;
 
+/* Clock device register image */
+using ClockRegs = std::array<uint8_t, clockRegsSize>;
+
+/**
+ * @brief Read the whole register space of a clock device.
+ *
+ * The registers are read in one I2C transfer, and only if that fails
+ * are they read again in small chunks so that one bad chunk doesn't
+ * lose the rest.  Registers that can't be read are left as 0xFF.
+ *
+ * @param[in] clockTarget - pdbg clock target
+ * @param[out] regs - the register image
+ *
+ * @return the number of registers read
+ */
+size_t readClockRegs(struct pdbg_target* clockTarget, ClockRegs& regs);
+
+/**
+ * @brief Read the registers of a sample group from the hardware.
+ *
+ * A sample holds, as big endian bytes, each CFAM register of each
+ * functional processor in turn, followed by each I2C range of each
+ * present clock.  Registers that can't be read are
+ * failedCFAMValue for CFAM and 0xFF for I2C.
+ *
+ * @param[in] group - the sample group
+ *
+ * @return the register values
+ */
+std::vector<uint8_t> collectSample(const SampleGroup& group);
+
+/**
+ * @brief Format a clock register image as hex, 16 registers to a line,
+ *        each line starting with the address of its first register.
+ *
+ * @param[in] regs - the register image
+ *
+ * @return the formatted image
+ */
+std::string formatClockRegs(const ClockRegs& regs);
+
 /**
  * @class Manager - Represents the clock daily management functions
  *
@@ -50,12 +97,14 @@ class Manager
     Manager(const sdeventplus::Event& event);
 
     /**
-     * @brief Add a dbus timer
+     * @brief Arm the timer for the next sample or log, whichever
+     *        must happen first.
      */
     void addTimer();
 
     /**
-     * @brief Callback when a timer expires
+     * @brief Callback when a timer expires, takes the samples that are
+     *        due and creates the clock data log if it is due.
      */
     void timerExpired();
 
@@ -76,16 +125,32 @@ class Manager
     /**
      * @brief Add clock specific register data to daily logger.
      *
+     * The register image of each clock is added as a binary FFDC
+     * section, sub type pel::clockRegsSubType, holding the clock
+     * index as a big endian uint32 followed by the clockRegsSize
+     * byte register image.
+     *
      * @param[out] ffdcData - reference to clock data log
+     * @param[out] ffdcSections - reference to clock data log sections
      */
-    void addClockRegData(openpower::pel::FFDCData& clockDataLog);
+    void addClockRegData(openpower::pel::FFDCData& clockDataLog,
+                         openpower::pel::FFDCSections& ffdcSections);
 
   private:
     /* The sdeventplus even loop to use */
     sdeventplus::Event _event;
 
-    /** @brief Timer used for LEDs lamp test period */
-    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+    /** @brief The sampling configuration */
+    SamplingConfig config;
+
+    /** @brief Samples the configured register groups */
+    Sampler sampler;
+
+    /** @brief When the next clock data log is due */
+    Sampler::Clock::time_point nextLog;
+
+    /** @brief Timer used for both sampling and logging */
+    Timer timer;
 };
 
 } // namespace openpower::phal::clock
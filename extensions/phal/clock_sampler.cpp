@@ -0,0 +1,223 @@
+#include "extensions/phal/clock_sampler.hpp"
+
+#include <nlohmann/json.hpp>
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+PHOSPHOR_LOG2_USING;
+
+namespace openpower::phal::clock
+{
+
+using json = nlohmann::json;
+
+/**
+ * @brief Read a number that may be given as a hex string
+ */
+static uint32_t getNumber(const json& value)
+{
+    if (value.is_string())
+    {
+        return std::stoul(value.get<std::string>(), nullptr, 0);
+    }
+    return value.get<uint32_t>();
+}
+
+/**
+ * @brief Appends a big endian value
+ */
+static void put(std::vector<uint8_t>& bytes, uint64_t value, size_t size)
+{
+    for (size_t i = size; i > 0; i--)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+    }
+}
+
+SamplingConfig loadSamplingConfig(const std::filesystem::path& path)
+{
+    SamplingConfig config;
+
+    std::ifstream file{path};
+    if (!file)
+    {
+        info("No clock sampling config {PATH}, using defaults", "PATH",
+             path.string());
+        return config;
+    }
+
+    json data;
+    try
+    {
+        data = json::parse(file);
+    }
+    catch (const std::exception& e)
+    {
+        error("Invalid clock sampling config {PATH}: {ERROR}", "PATH",
+              path.string(), "ERROR", e);
+        return config;
+    }
+
+    try
+    {
+        if (data.contains("logPeriodHours"))
+        {
+            auto hours = getNumber(data["logPeriodHours"]);
+            if (hours == 0)
+            {
+                throw std::out_of_range("logPeriodHours");
+            }
+            config.logPeriod = std::chrono::hours(hours);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        error("Invalid clock log period in {PATH}, using the default: "
+              "{ERROR}",
+              "PATH", path.string(), "ERROR", e);
+    }
+
+    for (const auto& entry : data.value("groups", json::array()))
+    {
+        try
+        {
+            SampleGroup group{entry.at("name").get<std::string>(),
+                              std::chrono::seconds(
+                                  getNumber(entry.at("periodSeconds"))),
+                              std::chrono::seconds(
+                                  getNumber(entry.value("jitterSeconds", 0))),
+                              getNumber(entry.value("retention", 1)),
+                              {},
+                              {}};
+
+            for (const auto& addr : entry.value("cfam", json::array()))
+            {
+                group.cfam.push_back(getNumber(addr));
+            }
+            for (const auto& range : entry.value("i2c", json::array()))
+            {
+                auto offset = getNumber(range.at("offset"));
+                auto size = getNumber(range.at("size"));
+                if (offset + size > clockRegsSize || size == 0)
+                {
+                    throw std::out_of_range("i2c range");
+                }
+                group.i2c.push_back({static_cast<uint8_t>(offset),
+                                     static_cast<uint16_t>(size)});
+            }
+
+            if (group.period.count() == 0 || group.retention == 0 ||
+                group.name.size() > UINT8_MAX)
+            {
+                throw std::out_of_range("period, retention or name");
+            }
+
+            config.groups.push_back(std::move(group));
+        }
+        catch (const std::exception& e)
+        {
+            error("Skipping invalid clock sampling group {GROUP}: {ERROR}",
+                  "GROUP", entry.dump(), "ERROR", e);
+        }
+    }
+
+    return config;
+}
+
+Sampler::Sampler(const std::vector<SampleGroup>& groups, Clock::time_point now,
+                 Collector collect) : collect(std::move(collect))
+{
+    for (const auto& group : groups)
+    {
+        this->groups.push_back({group, now, {}, false});
+    }
+}
+
+void Sampler::run(Clock::time_point now)
+{
+    for (auto& state : groups)
+    {
+        if (state.next > now)
+        {
+            continue;
+        }
+
+        auto values = collect(state.group);
+
+        // Only distinct samples are kept, so retention covers
+        // the most recent changes.
+        if (state.samples.empty() || state.samples.back().values != values)
+        {
+            state.changed = state.changed || !state.samples.empty();
+            state.samples.push_back(
+                {static_cast<uint64_t>(time(nullptr)), std::move(values)});
+            if (state.samples.size() > state.group.retention)
+            {
+                state.samples.pop_front();
+            }
+        }
+
+        // Stay on the period, unless sampling fell a whole period behind
+        state.next += state.group.period;
+        if (state.next <= now)
+        {
+            state.next = now + state.group.period;
+        }
+    }
+}
+
+Sampler::Clock::time_point Sampler::getWakeup() const
+{
+    auto wakeup = Clock::time_point::max();
+    for (const auto& state : groups)
+    {
+        wakeup = std::min(wakeup, state.next + state.group.jitter);
+    }
+    return wakeup;
+}
+
+std::vector<std::string> Sampler::takeChanges()
+{
+    std::vector<std::string> changes;
+    for (auto& state : groups)
+    {
+        if (state.changed)
+        {
+            changes.push_back("Samples " + state.group.name);
+            state.changed = false;
+        }
+    }
+    return changes;
+}
+
+openpower::pel::FFDCSections Sampler::getSections() const
+{
+    openpower::pel::FFDCSections sections;
+
+    for (const auto& state : groups)
+    {
+        std::vector<uint8_t> data;
+        put(data, state.group.name.size(), sizeof(uint8_t));
+        data.insert(data.end(), state.group.name.begin(),
+                    state.group.name.end());
+        put(data, state.samples.size(), sizeof(uint16_t));
+
+        for (const auto& sample : state.samples)
+        {
+            put(data, sample.time, sizeof(uint64_t));
+            put(data, sample.values.size(), sizeof(uint32_t));
+            data.insert(data.end(), sample.values.begin(),
+                        sample.values.end());
+        }
+
+        sections.push_back(
+            {openpower::pel::clockSamplesSubType, 1, std::move(data)});
+    }
+
+    return sections;
+}
+
+} // namespace openpower::phal::clock
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "extensions/phal/ffdc_section.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace openpower::phal::clock
+{
+
+/* Size of the clock device I2C register space */
+constexpr size_t clockRegsSize = 256;
+
+/**
+ * @brief A range of clock device I2C registers
+ */
+struct I2CRange
+{
+    uint8_t offset;
+    uint16_t size;
+};
+
+/**
+ * @brief A group of registers that are sampled together
+ */
+struct SampleGroup
+{
+    /** Name, used in the PEL */
+    std::string name;
+
+    /** How often to sample */
+    std::chrono::seconds period;
+
+    /** How late a sample may be taken, so it can share a wakeup */
+    std::chrono::seconds jitter;
+
+    /** How many distinct samples to keep */
+    size_t retention;
+
+    /** CFAM registers to read on every functional processor */
+    std::vector<uint32_t> cfam;
+
+    /** I2C registers to read on every present clock */
+    std::vector<I2CRange> i2c;
+};
+
+/**
+ * @brief The clock data logger configuration
+ */
+struct SamplingConfig
+{
+    /** How often to create the clock daily log */
+    std::chrono::seconds logPeriod = std::chrono::hours(24);
+
+    /** The register groups to sample between logs */
+    std::vector<SampleGroup> groups;
+};
+
+/**
+ * @brief Read the clock data logger configuration, a JSON file like
+ *
+ *   {
+ *     "logPeriodHours": 24,
+ *     "groups": [
+ *       {
+ *         "name": "health",
+ *         "periodSeconds": 60,
+ *         "jitterSeconds": 15,
+ *         "retention": 32,
+ *         "cfam": ["0x2810", "0x2813"],
+ *         "i2c": [{"offset": "0x00", "size": 16}]
+ *       }
+ *     ]
+ *   }
+ *
+ * Numbers may also be given as hex strings.  A missing file gives the
+ * default configuration, an invalid logPeriodHours is logged and the
+ * default kept, and invalid groups are logged and skipped.
+ *
+ * @param[in] path - the configuration file
+ *
+ * @return the configuration
+ */
+SamplingConfig loadSamplingConfig(const std::filesystem::path& path);
+
+/**
+ * @class Sampler
+ *
+ * Samples register groups on their own periods, keeping the most
+ * recent distinct samples of each group for the next clock daily log.
+ *
+ * The registers are read by a collector, see collectSample().
+ */
+class Sampler
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** Reads the registers of a group */
+    using Collector = std::function<std::vector<uint8_t>(const SampleGroup&)>;
+
+    Sampler() = delete;
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+    Sampler(Sampler&&) = delete;
+    Sampler& operator=(Sampler&&) = delete;
+    ~Sampler() = default;
+
+    /**
+     * Constructor
+     *
+     * @param[in] groups - the groups to sample
+     * @param[in] now - the current time, the first samples are due then
+     * @param[in] collect - reads the registers of a group
+     */
+    Sampler(const std::vector<SampleGroup>& groups, Clock::time_point now,
+            Collector collect);
+
+    /**
+     * @brief Sample every group that is due
+     *
+     * @param[in] now - the current time
+     */
+    void run(Clock::time_point now);
+
+    /**
+     * @brief Returns the latest time to call run() again, so that no
+     *        group is sampled later than its period plus jitter.
+     *        Clock::time_point::max() if there are no groups.
+     */
+    Clock::time_point getWakeup() const;
+
+    /**
+     * @brief Returns the names of the groups whose values changed since
+     *        the last call
+     */
+    std::vector<std::string> takeChanges();
+
+    /**
+     * @brief Returns the kept samples of each group as binary FFDC,
+     *        sub type pel::clockSamplesSubType, holding:
+     *          uint8 length, name
+     *          uint16 count, then count of
+     *            uint64 time, uint32 length, sample
+     *        all big endian, oldest sample first.
+     */
+    openpower::pel::FFDCSections getSections() const;
+
+  private:
+    /**
+     * One sample of a group
+     */
+    struct Sample
+    {
+        /** When it was taken, seconds since the epoch */
+        uint64_t time;
+
+        /** The register values */
+        std::vector<uint8_t> values;
+    };
+
+    /**
+     * A group and its samples
+     */
+    struct GroupState
+    {
+        SampleGroup group;
+        Clock::time_point next;
+        std::deque<Sample> samples;
+        bool changed = false;
+    };
+
+    /** Reads the registers of a group */
+    Collector collect;
+
+    /** The groups */
+    std::vector<GroupState> groups;
+};
+
+} // namespace openpower::phal::clock
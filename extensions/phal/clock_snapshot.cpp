@@ -0,0 +1,261 @@
+#include "extensions/phal/clock_snapshot.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <system_error>
+
+PHOSPHOR_LOG2_USING;
+
+namespace openpower::phal::clock
+{
+
+constexpr uint8_t snapshotVersion = 1;
+
+/**
+ * @brief Appends a big endian value
+ */
+static void put(std::vector<uint8_t>& bytes, uint64_t value, size_t size)
+{
+    for (size_t i = size; i > 0; i--)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+    }
+}
+
+/**
+ * @brief Reads big endian values, strings and blobs, failing once
+ *        the end is passed
+ */
+class Reader
+{
+  public:
+    explicit Reader(std::span<const uint8_t> bytes) : bytes(bytes) {}
+
+    std::optional<uint64_t> get(size_t size)
+    {
+        if (bytes.size() < size)
+        {
+            return std::nullopt;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            value = (value << 8) | bytes[i];
+        }
+        bytes = bytes.subspan(size);
+        return value;
+    }
+
+    std::optional<std::span<const uint8_t>> getBytes(size_t size)
+    {
+        if (bytes.size() < size)
+        {
+            return std::nullopt;
+        }
+        auto value = bytes.first(size);
+        bytes = bytes.subspan(size);
+        return value;
+    }
+
+    std::optional<std::string> getString()
+    {
+        auto size = get(sizeof(uint16_t));
+        if (!size)
+        {
+            return std::nullopt;
+        }
+        auto value = getBytes(*size);
+        if (!value)
+        {
+            return std::nullopt;
+        }
+        return std::string(value->begin(), value->end());
+    }
+
+  private:
+    std::span<const uint8_t> bytes;
+};
+
+std::vector<uint8_t> Snapshot::serialize() const
+{
+    std::vector<uint8_t> bytes{'C', 'L', 'K', 'S', snapshotVersion};
+    put(bytes, fullLogTime, sizeof(uint64_t));
+
+    auto putString = [&bytes](const std::string& value) {
+        put(bytes, value.size(), sizeof(uint16_t));
+        bytes.insert(bytes.end(), value.begin(), value.end());
+    };
+
+    put(bytes, data.size(), sizeof(uint32_t));
+    for (const auto& [key, value] : data)
+    {
+        putString(key);
+        putString(value);
+    }
+
+    put(bytes, sections.size(), sizeof(uint32_t));
+    for (const auto& section : sections)
+    {
+        put(bytes, section.subType, sizeof(uint8_t));
+        put(bytes, section.version, sizeof(uint8_t));
+        put(bytes, section.data.size(), sizeof(uint32_t));
+        bytes.insert(bytes.end(), section.data.begin(), section.data.end());
+    }
+
+    return bytes;
+}
+
+std::optional<Snapshot> Snapshot::deserialize(std::span<const uint8_t> bytes)
+{
+    Reader reader{bytes};
+
+    auto magic = reader.getBytes(4);
+    auto version = reader.get(sizeof(uint8_t));
+    auto time = reader.get(sizeof(uint64_t));
+    if (!magic || !std::equal(magic->begin(), magic->end(), "CLKS") ||
+        version != snapshotVersion || !time)
+    {
+        return std::nullopt;
+    }
+
+    Snapshot snapshot{{}, {}};
+    snapshot.fullLogTime = *time;
+
+    auto count = reader.get(sizeof(uint32_t));
+    if (!count)
+    {
+        return std::nullopt;
+    }
+    for (uint64_t i = 0; i < *count; i++)
+    {
+        auto key = reader.getString();
+        auto value = reader.getString();
+        if (!key || !value)
+        {
+            return std::nullopt;
+        }
+        snapshot.data.emplace_back(std::move(*key), std::move(*value));
+    }
+
+    count = reader.get(sizeof(uint32_t));
+    if (!count)
+    {
+        return std::nullopt;
+    }
+    for (uint64_t i = 0; i < *count; i++)
+    {
+        auto subType = reader.get(sizeof(uint8_t));
+        auto sectionVersion = reader.get(sizeof(uint8_t));
+        auto size = reader.get(sizeof(uint32_t));
+        if (!subType || !sectionVersion || !size)
+        {
+            return std::nullopt;
+        }
+        auto sectionData = reader.getBytes(*size);
+        if (!sectionData)
+        {
+            return std::nullopt;
+        }
+        snapshot.sections.push_back(
+            {static_cast<uint8_t>(*subType),
+             static_cast<uint8_t>(*sectionVersion),
+             std::vector<uint8_t>(sectionData->begin(), sectionData->end())});
+    }
+
+    return snapshot;
+}
+
+std::optional<Snapshot> Snapshot::load(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file),
+                               std::istreambuf_iterator<char>()};
+
+    auto snapshot = deserialize(bytes);
+    if (!snapshot)
+    {
+        error("Ignoring invalid clock data snapshot {PATH}", "PATH",
+              path.string());
+    }
+    return snapshot;
+}
+
+void Snapshot::save(const std::filesystem::path& path) const
+{
+    auto bytes = serialize();
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    {
+        std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        if (!file.flush())
+        {
+            error("Failed to write clock data snapshot {PATH}", "PATH",
+                  tmpPath.string());
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        error("Failed to save clock data snapshot {PATH}: {ERROR}", "PATH",
+              path.string(), "ERROR", ec.message());
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+std::vector<std::string> Snapshot::diff(const Snapshot& previous) const
+{
+    std::vector<std::string> changes;
+
+    std::map<std::string, std::string> before(previous.data.begin(),
+                                              previous.data.end());
+    std::map<std::string, std::string> after(data.begin(), data.end());
+
+    for (const auto& [key, value] : after)
+    {
+        auto old = before.find(key);
+        if (old == before.end() || old->second != value)
+        {
+            changes.push_back(key);
+        }
+    }
+    for (const auto& [key, value] : before)
+    {
+        if (!after.contains(key))
+        {
+            changes.push_back(key);
+        }
+    }
+
+    auto count = std::max(sections.size(), previous.sections.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i >= sections.size() || i >= previous.sections.size() ||
+            sections[i].subType != previous.sections[i].subType ||
+            sections[i].version != previous.sections[i].version ||
+            sections[i].data != previous.sections[i].data)
+        {
+            changes.push_back("FFDC section " + std::to_string(i));
+        }
+    }
+
+    return changes;
+}
+
+} // namespace openpower::phal::clock
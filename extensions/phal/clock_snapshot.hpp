@@ -0,0 +1,116 @@
+#pragma once
+
+#include "extensions/phal/ffdc_section.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openpower::phal::clock
+{
+
+/**
+ * @class Snapshot
+ *
+ * The contents of a clock daily log, kept from one run to the next so
+ * that a full log is only created when something has changed.
+ */
+class Snapshot
+{
+  public:
+    /**
+     * Constructor
+     *
+     * @param[in] data - the additional data of the log
+     * @param[in] sections - the binary FFDC of the log
+     */
+    Snapshot(openpower::pel::FFDCData data,
+             openpower::pel::FFDCSections sections) :
+        data(std::move(data)), sections(std::move(sections))
+    {}
+
+    /**
+     * @brief Read a snapshot saved by save()
+     *
+     * @param[in] path - the file to read
+     *
+     * @return the snapshot, or nothing if there isn't a valid one
+     */
+    static std::optional<Snapshot> load(const std::filesystem::path& path);
+
+    /**
+     * @brief Save the snapshot, replacing the file atomically.
+     *        Failures are logged, not thrown.
+     *
+     * @param[in] path - the file to write
+     */
+    void save(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Compare with an earlier snapshot
+     *
+     * @param[in] previous - the earlier snapshot
+     *
+     * @return the names of the additional data keys and FFDC sections
+     *         that were added, removed or changed
+     */
+    std::vector<std::string> diff(const Snapshot& previous) const;
+
+    /**
+     * @brief Returns when the last full log was created
+     *
+     * @return seconds since the epoch, 0 if never
+     */
+    uint64_t getFullLogTime() const
+    {
+        return fullLogTime;
+    }
+
+    /**
+     * @brief Sets when the last full log was created
+     *
+     * @param[in] time - seconds since the epoch
+     */
+    void setFullLogTime(uint64_t time)
+    {
+        fullLogTime = time;
+    }
+
+  private:
+    /**
+     * @brief Serialize the snapshot, all fields big endian:
+     *   char magic[4]  "CLKS"
+     *   uint8 version
+     *   uint64 fullLogTime
+     *   uint32 count, then count of
+     *     uint16 length, key, uint16 length, value
+     *   uint32 count, then count of
+     *     uint8 subType, uint8 version, uint32 length, data
+     *
+     * @return the serialized snapshot
+     */
+    std::vector<uint8_t> serialize() const;
+
+    /**
+     * @brief Deserialize a snapshot written by serialize()
+     *
+     * @param[in] bytes - the serialized snapshot
+     *
+     * @return the snapshot, or nothing if it isn't valid
+     */
+    static std::optional<Snapshot> deserialize(std::span<const uint8_t> bytes);
+
+    /** The additional data of the log */
+    openpower::pel::FFDCData data;
+
+    /** The binary FFDC of the log */
+    openpower::pel::FFDCSections sections;
+
+    /** When the last full log was created, seconds since the epoch */
+    uint64_t fullLogTime = 0;
+};
+
+} // namespace openpower::phal::clock
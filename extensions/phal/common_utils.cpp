@@ -4,6 +4,7 @@
 
 #include "extensions/phal/pdbg_utils.hpp"
 #include "extensions/phal/phal_error.hpp"
+#include "timing.hpp"
 
 #include <libekb.H>
 
@@ -18,6 +19,8 @@ using namespace phosphor::logging;
 
 void phal_init(enum ipl_mode mode)
 {
+    util::timing::Span span{"phal_init"};
+
     // TODO: Setting boot error callback should not be in common code
     //       because, we won't get proper reason in PEL for failure.
     //       So, need to make code like caller of this function pass error
@@ -25,19 +28,32 @@ void phal_init(enum ipl_mode mode)
     // add callback methods for debug traces and for boot failures
     openpower::pel::addBootErrorCallbacks();
 
-    // PDBG_DTB environment variable set to CEC device tree path
-    setDevtreeEnv();
+    // pdbg and libekb keep their state for the life of the process, and
+    // can't be initialized twice, which matters when running as a daemon.
+    static bool pdbgInitialized = false;
+    static bool libekbInitialized = false;
 
-    if (!pdbg_targets_init(NULL))
+    if (!pdbgInitialized)
     {
-        log<level::ERR>("pdbg_targets_init failed");
-        throw std::runtime_error("pdbg target initialization failed");
+        // PDBG_DTB environment variable set to CEC device tree path
+        setDevtreeEnv();
+
+        if (!pdbg_targets_init(NULL))
+        {
+            log<level::ERR>("pdbg_targets_init failed");
+            throw std::runtime_error("pdbg target initialization failed");
+        }
+        pdbgInitialized = true;
     }
 
-    if (libekb_init())
+    if (!libekbInitialized)
     {
-        log<level::ERR>("libekb_init failed");
-        throw std::runtime_error("libekb initialization failed");
+        if (libekb_init())
+        {
+            log<level::ERR>("libekb_init failed");
+            throw std::runtime_error("libekb initialization failed");
+        }
+        libekbInitialized = true;
     }
 
     if (ipl_init(mode) != 0)
@@ -51,7 +67,8 @@ bool isPrimaryProc(struct pdbg_target* procTarget)
 {
     ATTR_PROC_MASTER_TYPE_Type type;
 
-    // Get processor type (Primary or Secondary)
+    // Get processor type (Primary or Secondary).  A single lookup through
+    // the devtree API is cheaper than building the attribute index.
     if (DT_GET_PROP(ATTR_PROC_MASTER_TYPE, procTarget, type))
     {
         log<level::ERR>("Attribute [ATTR_PROC_MASTER_TYPE] get failed");
@@ -15,6 +15,8 @@ namespace phal
 /**
  * @brief This function will initialize required phal
  *        libraries.
+ * pdbg and libekb are only initialized on the first call in a
+ * process, libipl is initialized on every call.
  * Throws an exception on error.
  *
  * @param[in] mode - IPL mode, default IPL_AUTOBOOT
@@ -2,23 +2,20 @@
 
 #include "attributes_info.H"
 
+#include "timing.hpp"
 #include "util.hpp"
 
-#include <fcntl.h>
 #include <libekb.H>
 #include <libphal.H>
-#include <unistd.h>
 
 #include <phosphor-logging/elog.hpp>
 #include <xyz/openbmc_project/Logging/Create/server.hpp>
 #include <xyz/openbmc_project/Logging/Entry/server.hpp>
 
-#include <cerrno>
-#include <cstdio>
-#include <cstdlib>
 #include <cstring>
 #include <format>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -35,6 +32,37 @@ constexpr auto loggingObjectPath = "/xyz/openbmc_project/logging";
 constexpr auto loggingInterface = "xyz.openbmc_project.Logging.Create";
 constexpr auto opLoggingInterface = "org.open_power.Logging.PEL";
 
+using FFDCFileInfo = std::vector<std::tuple<
+    sdbusplus::xyz::openbmc_project::Logging::server::Create::FFDCFormat,
+    uint8_t, uint8_t, sdbusplus::message::unix_fd>>;
+
+/**
+ * @brief Create an FFDC file for each binary FFDC section and add it
+ *        to the list of FFDC files to pass to the logging service
+ *
+ * @param[in] ffdcSections - the binary FFDC
+ * @param[out] ffdcFileInfo - the FFDC file list
+ *
+ * @return the files, which have to be kept until the PEL is created
+ */
+static std::vector<std::unique_ptr<FFDCFile>>
+    addFFDCSections(const FFDCSections& ffdcSections,
+                    FFDCFileInfo& ffdcFileInfo)
+{
+    std::vector<std::unique_ptr<FFDCFile>> files;
+
+    for (const auto& section : ffdcSections)
+    {
+        files.push_back(std::make_unique<FFDCFile>(section.data));
+        ffdcFileInfo.emplace_back(sdbusplus::xyz::openbmc_project::Logging::
+                                      server::Create::FFDCFormat::Custom,
+                                  section.subType, section.version,
+                                  files.back()->getFileFD());
+    }
+
+    return files;
+}
+
 /**
  * @brief get SBE special callout information
  *
@@ -79,10 +107,11 @@ static void getSBECallout(struct pdbg_target* procTarget,
 }
 
 void createErrorPEL(const std::string& event, const json& calloutData,
-                    const FFDCData& ffdcData, const Severity severity)
+                    const FFDCData& ffdcData, const Severity severity,
+                    const FFDCSections& ffdcSections)
 {
     std::map<std::string, std::string> additionalData;
-    auto bus = sdbusplus::bus::new_default();
+    auto& bus = util::getBus();
     additionalData.emplace("_PID", std::to_string(getpid()));
     for (auto& data : ffdcData)
     {
@@ -104,8 +133,10 @@ void createErrorPEL(const std::string& event, const json& calloutData,
                             static_cast<uint8_t>(0xCA),
                             static_cast<uint8_t>(0x01), ffdcFile.getFileFD()));
 
+        auto sectionFiles = addFFDCSections(ffdcSections, pelCalloutInfo);
+
         std::string service =
-            util::getService(bus, loggingObjectPath, loggingInterface);
+            util::getService(loggingObjectPath, loggingInterface);
         auto method =
             bus.new_method_call(service.c_str(), loggingObjectPath,
                                 loggingInterface, "CreateWithFFDCFiles");
@@ -113,6 +144,7 @@ void createErrorPEL(const std::string& event, const json& calloutData,
             sdbusplus::xyz::openbmc_project::Logging::server::convertForMessage(
                 severity);
         method.append(event, level, additionalData, pelCalloutInfo);
+        util::timing::Span span{"D-Bus CreateWithFFDCFiles"};
         auto resp = bus.call(method);
     }
     catch (const sdbusplus::exception_t& e)
@@ -134,11 +166,12 @@ void createErrorPEL(const std::string& event, const json& calloutData,
 uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
                            const FFDCData& ffdcData,
                            struct pdbg_target* procTarget,
-                           const Severity severity)
+                           const Severity severity,
+                           const FFDCSections& ffdcSections)
 {
     uint32_t plid = 0;
     std::map<std::string, std::string> additionalData;
-    auto bus = sdbusplus::bus::new_default();
+    auto& bus = util::getBus();
 
     additionalData.emplace("_PID", std::to_string(getpid()));
     additionalData.emplace("SBE_ERR_MSG", sbeError.what());
@@ -167,8 +200,8 @@ uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
         pelFFDCInfo.push_back(
             std::make_tuple(sdbusplus::xyz::openbmc_project::Logging::server::
                                 Create::FFDCFormat::Custom,
-                            static_cast<uint8_t>(0xCB),
-                            static_cast<uint8_t>(0x01), sbeError.getFd()));
+                            sbeFFDCSubType, static_cast<uint8_t>(0x01),
+                            sbeError.getFd()));
     }
 
     // Workaround : currently sbe_extract_rc hwp procedure based callout
@@ -204,8 +237,10 @@ uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
 
     try
     {
+        auto sectionFiles = addFFDCSections(ffdcSections, pelFFDCInfo);
+
         std::string service =
-            util::getService(bus, loggingObjectPath, opLoggingInterface);
+            util::getService(loggingObjectPath, opLoggingInterface);
         auto method =
             bus.new_method_call(service.c_str(), loggingObjectPath,
                                 opLoggingInterface, "CreatePELWithFFDCFiles");
@@ -213,6 +248,7 @@ uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
             sdbusplus::xyz::openbmc_project::Logging::server::convertForMessage(
                 severity);
         method.append(event, level, additionalData, pelFFDCInfo);
+        util::timing::Span span{"D-Bus CreatePELWithFFDCFiles"};
         auto response = bus.call(method);
 
         // reply will be tuple containing bmc log id, platform log id
@@ -240,10 +276,10 @@ uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
 }
 
 void createPEL(const std::string& event, const FFDCData& ffdcData,
-               const Severity severity)
+               const Severity severity, const FFDCSections& ffdcSections)
 {
     std::map<std::string, std::string> additionalData;
-    auto bus = sdbusplus::bus::new_default();
+    auto& bus = util::getBus();
 
     additionalData.emplace("_PID", std::to_string(getpid()));
     for (auto& data : ffdcData)
@@ -253,14 +289,23 @@ void createPEL(const std::string& event, const FFDCData& ffdcData,
 
     try
     {
+        FFDCFileInfo ffdcFileInfo;
+        auto sectionFiles = addFFDCSections(ffdcSections, ffdcFileInfo);
+
         std::string service =
-            util::getService(bus, loggingObjectPath, loggingInterface);
-        auto method = bus.new_method_call(service.c_str(), loggingObjectPath,
-                                          loggingInterface, "Create");
+            util::getService(loggingObjectPath, loggingInterface);
+        auto method = bus.new_method_call(
+            service.c_str(), loggingObjectPath, loggingInterface,
+            ffdcFileInfo.empty() ? "Create" : "CreateWithFFDCFiles");
         auto level =
             sdbusplus::xyz::openbmc_project::Logging::server::convertForMessage(
                 severity);
         method.append(event, level, additionalData);
+        if (!ffdcFileInfo.empty())
+        {
+            method.append(ffdcFileInfo);
+        }
+        util::timing::Span span{"D-Bus Create"};
         auto resp = bus.call(method);
     }
     catch (const sdbusplus::exception_t& e)
@@ -285,85 +330,16 @@ void createPEL(const std::string& event, const FFDCData& ffdcData,
 }
 
 FFDCFile::FFDCFile(const json& pHALCalloutData) :
-    calloutData(pHALCalloutData.dump()),
-    calloutFile("/tmp/phalPELCalloutsJson.XXXXXX"), fileFD(-1)
-{
-    prepareFFDCFile();
-}
+    file("phalPELCalloutsJson", pHALCalloutData.dump())
+{}
 
-FFDCFile::~FFDCFile()
-{
-    removeCalloutFile();
-}
+FFDCFile::FFDCFile(const std::vector<uint8_t>& ffdcData) :
+    file("phalPELFFDC", ffdcData)
+{}
 
 int FFDCFile::getFileFD() const
 {
-    return fileFD;
-}
-
-void FFDCFile::prepareFFDCFile()
-{
-    createCalloutFile();
-    writeCalloutData();
-    setCalloutFileSeekPos();
-}
-
-void FFDCFile::createCalloutFile()
-{
-    fileFD = mkostemp(const_cast<char*>(calloutFile.c_str()), O_RDWR);
-
-    if (fileFD == -1)
-    {
-        log<level::ERR>(std::format("Failed to create phalPELCallouts "
-                                    "file({}), errorno({}) and errormsg({})",
-                                    calloutFile, errno, strerror(errno))
-                            .c_str());
-        throw std::runtime_error("Failed to create phalPELCallouts file");
-    }
-}
-
-void FFDCFile::writeCalloutData()
-{
-    ssize_t rc = write(fileFD, calloutData.c_str(), calloutData.size());
-
-    if (rc == -1)
-    {
-        log<level::ERR>(std::format("Failed to write phaPELCallout info "
-                                    "in file({}), errorno({}), errormsg({})",
-                                    calloutFile, errno, strerror(errno))
-                            .c_str());
-        throw std::runtime_error("Failed to write phalPELCallouts info");
-    }
-    else if (rc != static_cast<ssize_t>(calloutData.size()))
-    {
-        log<level::WARNING>(std::format("Could not write all phal callout "
-                                        "info in file({}), written byte({}) "
-                                        "and total byte({})",
-                                        calloutFile, rc, calloutData.size())
-                                .c_str());
-    }
-}
-
-void FFDCFile::setCalloutFileSeekPos()
-{
-    int rc = lseek(fileFD, 0, SEEK_SET);
-
-    if (rc == -1)
-    {
-        log<level::ERR>(std::format("Failed to set SEEK_SET for "
-                                    "phalPELCallouts in file({}), errorno({}) "
-                                    "and errormsg({})",
-                                    calloutFile, errno, strerror(errno))
-                            .c_str());
-        throw std::runtime_error(
-            "Failed to set SEEK_SET for phalPELCallouts file");
-    }
-}
-
-void FFDCFile::removeCalloutFile()
-{
-    close(fileFD);
-    std::remove(calloutFile.c_str());
+    return file.getFD();
 }
 
 } // namespace pel
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "extensions/phal/ffdc_section.hpp"
+#include "memory_file.hpp"
 #include "xyz/openbmc_project/Logging/Entry/server.hpp"
 
 #include <phal_exception.H>
@@ -17,8 +19,6 @@ namespace openpower
 {
 namespace pel
 {
-using FFDCData = std::vector<std::pair<std::string, std::string>>;
-
 using json = nlohmann::json;
 
 using namespace openpower::phal;
@@ -30,10 +30,12 @@ using Severity = sdbusplus::xyz::openbmc_project::Logging::server::Entry::Level;
  * @param[in] calloutData - callout data to append to PEL
  * @param[in] ffdcData - failure data to append to PEL
  * @param[in] severity - severity of the log default to Informational
+ * @param[in] ffdcSections - binary FFDC to attach to the PEL
  */
 void createErrorPEL(const std::string& event, const json& calloutData = {},
                     const FFDCData& ffdcData = {},
-                    const Severity severity = Severity::Informational);
+                    const Severity severity = Severity::Informational,
+                    const FFDCSections& ffdcSections = {});
 
 /**
  * @brief Create SBE boot error PEL and return id
@@ -43,12 +45,14 @@ void createErrorPEL(const std::string& event, const json& calloutData = {},
  * @param[in] ffdcData - failure data to append to PEL
  * @param[in] procTarget - pdbg processor target
  * @param[in] severity - severity of the log
+ * @param[in] ffdcSections - binary FFDC to attach to the PEL
  * @return Platform log id
  */
 uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
                            const FFDCData& ffdcData,
                            struct pdbg_target* procTarget,
-                           const Severity severity = Severity::Error);
+                           const Severity severity = Severity::Error,
+                           const FFDCSections& ffdcSections = {});
 
 /**
  * @brief Create a PEL for the specified event type and additional data
@@ -56,13 +60,17 @@ uint32_t createSbeErrorPEL(const std::string& event, const sbeError_t& sbeError,
  *  @param[in]  event - the event type
  *  @param[in] ffdcData - failure data to append to PEL
  *  @param[in] severity - severity of the log
+ *  @param[in] ffdcSections - binary FFDC to attach to the PEL
  */
 void createPEL(const std::string& event, const FFDCData& ffdcData = {},
-               const Severity severity = Severity::Error);
+               const Severity severity = Severity::Error,
+               const FFDCSections& ffdcSections = {});
 
 /**
  * @class FFDCFile
  * @brief This class is used to create ffdc data file and to get fd
+ *
+ * The file only exists in memory, see util::MemoryFile.
  */
 class FFDCFile
 {
@@ -80,9 +88,9 @@ class FFDCFile
     explicit FFDCFile(const json& pHALCalloutData);
 
     /**
-     * Used to remove created ffdc file.
+     * Used to create unique ffdc file with the passed binary data.
      */
-    ~FFDCFile();
+    explicit FFDCFile(const std::vector<uint8_t>& ffdcData);
 
     /**
      * Used to get created ffdc file file descriptor id.
@@ -93,56 +101,9 @@ class FFDCFile
 
   private:
     /**
-     * Used to store callout ffdc data from passed json object.
-     */
-    std::string calloutData;
-
-    /**
-     * Used to store unique ffdc file name.
-     */
-    std::string calloutFile;
-
-    /**
-     * Used to store created ffdc file descriptor id.
+     * The ffdc file, closed when this object is destroyed.
      */
-    int fileFD;
-
-    /**
-     * Used to create ffdc file to pass PEL api for creating
-     * pel records.
-     *
-     * @return NULL
-     */
-    void prepareFFDCFile();
-
-    /**
-     * Create unique ffdc file.
-     *
-     * @return NULL
-     */
-    void createCalloutFile();
-
-    /**
-     * Used write json object value into created file.
-     *
-     * @return NULL
-     */
-    void writeCalloutData();
-
-    /**
-     * Used set ffdc file seek position beginning to consume by PEL
-     *
-     * @return NULL
-     */
-    void setCalloutFileSeekPos();
-
-    /**
-     * Used to remove created ffdc file.
-     *
-     * @return NULL
-     */
-    void removeCalloutFile();
-
+    util::MemoryFile file;
 }; // FFDCFile end
 
 } // namespace pel
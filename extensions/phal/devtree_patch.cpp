@@ -0,0 +1,205 @@
+#include "extensions/phal/devtree_patch.hpp"
+
+#include "temporary_file.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/log.hpp>
+
+#include <algorithm>
+#include <format>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace openpower::phal
+{
+
+using namespace phosphor::logging;
+
+constexpr uint64_t hashInit = 0xCBF29CE484222325;
+
+/**
+ * @brief 64 bit FNV-1a hash, to detect changes
+ */
+static uint64_t hashBytes(std::span<const uint8_t> bytes,
+                          uint64_t hash = hashInit)
+{
+    for (auto byte : bytes)
+    {
+        hash = (hash ^ byte) * 0x100000001B3;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hash a string and its terminator, so that consecutive strings
+ *        hash differently to their concatenation
+ */
+static uint64_t hashString(std::string_view str, uint64_t hash = hashInit)
+{
+    hash = hashBytes(
+        {reinterpret_cast<const uint8_t*>(str.data()), str.size()}, hash);
+    return hashBytes({reinterpret_cast<const uint8_t*>(""), 1}, hash);
+}
+
+std::set<std::string, std::less<>> getPreservedAttrs(const std::string& list)
+{
+    std::set<std::string, std::less<>> attrs;
+    std::istringstream lines{list};
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        std::istringstream words{line};
+        std::string name;
+        if (!(words >> name) || name.starts_with('#'))
+        {
+            continue;
+        }
+        attrs.insert(name);
+        if (!name.starts_with("ATTR_"))
+        {
+            attrs.insert("ATTR_" + name);
+        }
+    }
+    return attrs;
+}
+
+uint64_t hashUnpreserved(const FdtFile& devtree,
+                         const std::set<std::string, std::less<>>& preserved)
+{
+    uint64_t hash = hashInit;
+    size_t pos = 0;
+    for (auto token = devtree.next(pos);
+         token.type != FdtFile::Token::Type::End; token = devtree.next(pos))
+    {
+        uint8_t type = static_cast<uint8_t>(token.type);
+        hash = hashBytes({&type, 1}, hash);
+        hash = hashString(token.name, hash);
+        if (token.type == FdtFile::Token::Type::Property &&
+            !preserved.contains(token.name))
+        {
+            hash = hashBytes(token.value, hash);
+        }
+    }
+    return hash;
+}
+
+Fingerprint getFingerprint(const FdtFile& ro, const std::string& list,
+                           const FdtFile& rw)
+{
+    return {hashBytes(ro.getData()), hashString(list),
+            hashUnpreserved(rw, getPreservedAttrs(list))};
+}
+
+bool patchDevtree(const FdtFile& ro, const FdtFile& rw,
+                  const std::set<std::string, std::less<>>& preserved,
+                  const std::filesystem::path& rwFilePath)
+{
+    std::vector<std::pair<size_t, std::span<const uint8_t>>> patches;
+    std::set<std::string_view> found;
+
+    size_t roPos = 0;
+    size_t rwPos = 0;
+    while (true)
+    {
+        auto roToken = ro.next(roPos);
+        auto rwToken = rw.next(rwPos);
+        if (roToken.type != rwToken.type || roToken.name != rwToken.name ||
+            roToken.value.size() != rwToken.value.size())
+        {
+            log<level::INFO>("reinitDevtree: devtree structure differs");
+            return false;
+        }
+
+        if (rwToken.type == FdtFile::Token::Type::End)
+        {
+            break;
+        }
+        if (rwToken.type != FdtFile::Token::Type::Property)
+        {
+            continue;
+        }
+
+        if (auto attr = preserved.find(rwToken.name); attr != preserved.end())
+        {
+            found.insert(*attr);
+        }
+        else if (!std::ranges::equal(roToken.value, rwToken.value))
+        {
+            patches.emplace_back(rwToken.offset, roToken.value);
+        }
+    }
+
+    // Every listed attribute must exist under one of its names, so a
+    // naming mismatch can never reset a preserved value.
+    for (const auto& name : preserved)
+    {
+        if (!found.contains(name) &&
+            !found.contains(name.starts_with("ATTR_") ? name.substr(5)
+                                                      : "ATTR_" + name))
+        {
+            log<level::INFO>(
+                std::format("reinitDevtree: preserved attribute {} not found",
+                            name)
+                    .c_str());
+            return false;
+        }
+    }
+
+    // Only the patched blocks are written where the r/w copy can share
+    // the rest, and the r/w file is replaced in one rename.
+    openpower::util::TemporaryFile tmpFile{rwFilePath.parent_path()};
+    tmpFile.copyFrom(rwFilePath);
+
+    int fd = open(tmpFile.getPath().c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::runtime_error("reinitDevtree: failed to open patch file");
+    }
+    for (const auto& [offset, value] : patches)
+    {
+        if (pwrite(fd, value.data(), value.size(), offset) !=
+            static_cast<ssize_t>(value.size()))
+        {
+            close(fd);
+            throw std::runtime_error("reinitDevtree: failed to patch devtree");
+        }
+    }
+    close(fd);
+
+    tmpFile.moveTo(rwFilePath);
+
+    log<level::INFO>(
+        std::format("reinitDevtree: patched {} attributes", patches.size())
+            .c_str());
+    return true;
+}
+
+bool updateFromFingerprint(const FdtFile& ro, const std::string& list,
+                           const std::filesystem::path& rwFilePath,
+                           const Fingerprint& previous)
+{
+    FdtFile rw{rwFilePath};
+    auto current = getFingerprint(ro, list, rw);
+
+    if ((current.roHash != previous.roHash) ||
+        (current.listHash != previous.listHash))
+    {
+        return false;
+    }
+
+    if (current.rwHash == previous.rwHash)
+    {
+        log<level::INFO>("reinitDevtree: no attributes to reinit");
+        return true;
+    }
+
+    return patchDevtree(ro, rw, getPreservedAttrs(list), rwFilePath);
+}
+
+} // namespace openpower::phal
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "extensions/phal/fdt_file.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <string>
+
+namespace openpower::phal
+{
+
+/**
+ * @brief What the r/w devtree was last built from, and a hash of it
+ *        leaving out the values of the preserved attributes.  If these
+ *        are unchanged, rebuilding the r/w devtree would give the same
+ *        file again.
+ */
+struct Fingerprint
+{
+    uint64_t roHash;
+    uint64_t listHash;
+    uint64_t rwHash;
+};
+
+/**
+ * @brief Get the names of the preserved attributes from the reinit
+ *        attribute list, the first word of each line.  Names are
+ *        matched with and without the ATTR_ prefix.
+ *
+ * @param[in] list - the contents of the reinit attribute list
+ *
+ * @return the attribute names
+ */
+std::set<std::string, std::less<>> getPreservedAttrs(const std::string& list);
+
+/**
+ * @brief Hash the devtree structure, leaving out the values of the
+ *        preserved attributes.
+ *
+ * @param[in] devtree - the devtree
+ * @param[in] preserved - the preserved attribute names
+ *
+ * @return the hash
+ */
+uint64_t hashUnpreserved(const FdtFile& devtree,
+                         const std::set<std::string, std::less<>>& preserved);
+
+/**
+ * @brief Get the fingerprint of a r/w devtree
+ *
+ * @param[in] ro - the r/o devtree it was built from
+ * @param[in] list - the contents of the reinit attribute list
+ * @param[in] rw - the r/w devtree
+ *
+ * @return the fingerprint
+ */
+Fingerprint getFingerprint(const FdtFile& ro, const std::string& list,
+                           const FdtFile& rw);
+
+/**
+ * @brief Patch the attributes of the r/w devtree that are not preserved
+ *        and differ from the r/o devtree, so it matches what a full
+ *        reinit would build.  The r/w file is replaced in one rename.
+ *
+ * @param[in] ro - the r/o devtree
+ * @param[in] rw - the r/w devtree
+ * @param[in] preserved - the preserved attribute names
+ * @param[in] rwFilePath - the r/w devtree file
+ *
+ * @return false if the devtrees don't have the same structure, or not
+ *         all preserved attributes were found, and a full reinit is
+ *         needed.
+ */
+bool patchDevtree(const FdtFile& ro, const FdtFile& rw,
+                  const std::set<std::string, std::less<>>& preserved,
+                  const std::filesystem::path& rwFilePath);
+
+/**
+ * @brief Skip the reinit, or patch only the changed attributes, when
+ *        the r/o devtree and the reinit attribute list are the ones the
+ *        r/w devtree was last built from.
+ *
+ * @param[in] ro - the r/o devtree
+ * @param[in] list - the contents of the reinit attribute list
+ * @param[in] rwFilePath - the r/w devtree file
+ * @param[in] previous - the fingerprint saved when the r/w devtree
+ *                       was last built
+ *
+ * @return true if the r/w devtree is up to date, false if a full
+ *         reinit is needed.
+ */
+bool updateFromFingerprint(const FdtFile& ro, const std::string& list,
+                           const std::filesystem::path& rwFilePath,
+                           const Fingerprint& previous);
+
+} // namespace openpower::phal
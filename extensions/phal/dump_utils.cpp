@@ -8,24 +8,50 @@
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/exception.hpp>
 #include <sdbusplus/server.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/time.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <format>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <variant>
 
 namespace openpower::phal::dump
 {
 
 using namespace phosphor::logging;
 
+constexpr auto progressInterface = "xyz.openbmc_project.Common.Progress";
+constexpr auto createInterface = "xyz.openbmc_project.Dump.Create";
+
+/**
+ * Check if a dump progress status means the dump is no longer running
+ *
+ * @param[in] status The Progress interface Status property value
+ * @return true if the dump is done, successfully or not
+ */
+static bool isDumpDone(const std::string& status)
+{
+    return status != "xyz.openbmc_project.Common.Progress."
+                     "OperationStatus.InProgress";
+}
+
 /**
  *  Callback for dump request properties change signal monitor
  *
  * @param[in] msg         Dbus message from the dbus match infrastructure
  * @param[in] path        The object path we are monitoring
- * @param[out] inProgress Used to break out of our dbus wait loop
+ * @param[in] done        Called when the dump is done
  * @reutn Always non-zero indicating no error, no cascading callbacks
  */
 uint32_t dumpStatusChanged(sdbusplus::message_t& msg, const std::string& path,
-                           bool& inProgress)
+                           const std::function<void(const std::string&)>& done)
 {
     // reply (msg) will be a property change message
     std::string interface;
@@ -41,14 +67,13 @@ uint32_t dumpStatusChanged(sdbusplus::message_t& msg, const std::string& path,
         const std::string* status =
             std::get_if<std::string>(&(dumpStatus->second));
 
-        if ((nullptr != status) && ("xyz.openbmc_project.Common.Progress."
-                                    "OperationStatus.InProgress" != *status))
+        if ((nullptr != status) && isDumpDone(*status))
         {
-            // dump is done, trace some info and change in progress flag
+            // dump is done, trace some info and stop monitoring it
             log<level::INFO>(std::format("Dump status({}) : path={}",
                                          status->c_str(), path.c_str())
                                  .c_str());
-            inProgress = false;
+            done(path);
         }
     }
 
@@ -56,116 +81,315 @@ uint32_t dumpStatusChanged(sdbusplus::message_t& msg, const std::string& path,
 }
 
 /**
- * Register a callback for dump progress status changes
+ * Read the current dump progress status
  *
- * @param[in] path The object path of the dump to monitor
- * @param timeout - timeout - timeout interval in seconds
+ * @param[in] bus     The bus to use
+ * @param[in] service The dump manager service
+ * @param[in] path    The object path of the dump
+ * @return the status, or nothing if it could not be read
  */
-void monitorDump(const std::string& path, const uint32_t timeout)
+static std::optional<std::string> getDumpStatus(sdbusplus::bus_t& bus,
+                                                const std::string& service,
+                                                const std::string& path)
 {
-    bool inProgress = true; // callback will update this
-
-    // setup the signal match rules and callback
-    std::string matchInterface = "xyz.openbmc_project.Common.Progress";
-    auto bus = sdbusplus::bus::new_system();
-
-    std::unique_ptr<sdbusplus::match> match =
-        std::make_unique<sdbusplus::match>(
-            bus,
-            sdbusplus::match_rules::propertiesChanged(path.c_str(),
-                                                      matchInterface.c_str()),
-            [&](auto& msg) {
-                return dumpStatusChanged(msg, path, inProgress);
-            });
-
-    // wait for dump status to be completed (complete == true)
-    // or until timeout interval
-    log<level::INFO>("dump requested (waiting)");
-    bool timedOut = false;
-    uint32_t secondsCount = 0;
-    while ((true == inProgress) && !timedOut)
+    try
     {
-        bus.wait(std::chrono::seconds(1));
-        bus.process_discard();
+        auto method =
+            bus.new_method_call(service.c_str(), path.c_str(),
+                                "org.freedesktop.DBus.Properties", "Get");
+        method.append(progressInterface, "Status");
 
-        if (++secondsCount == timeout)
-        {
-            timedOut = true;
-        }
+        auto reply = bus.call(method);
+        std::variant<std::string> status;
+        reply.read(status);
+        return std::get<std::string>(status);
     }
-    if (timedOut)
+    catch (const sdbusplus::exception_t& e)
     {
-        log<level::ERR>("Dump progress status did not change to "
-                        "complete within the timeout interval, exiting...");
+        // The status change signal will still be seen
+        log<level::INFO>(std::format("Failed to read dump status, path={}, "
+                                     "EXCEPTION={}",
+                                     path, e.what())
+                             .c_str());
     }
+    return std::nullopt;
 }
 
-void requestDump(const DumpParameters& dumpParameters)
+/**
+ * Request a dump from the dump manager
+ *
+ * @param[in] bus            The bus to use
+ * @param[in] service        The dump manager service
+ * @param[in] dumpParameters Parameters for the dump request
+ * @return the object path of the new dump
+ */
+static std::string createDump(sdbusplus::bus_t& bus,
+                              const std::string& service,
+                              const DumpParameters& dumpParameters)
 {
     log<level::INFO>(std::format("Requesting Dump PEL({}) Index({})",
                                  dumpParameters.logId, dumpParameters.unitId)
                          .c_str());
 
-    constexpr auto path = OP_DUMP_OBJ_PATH;
-    constexpr auto interface = "xyz.openbmc_project.Dump.Create";
     constexpr auto function = "CreateDump";
 
-    sdbusplus::message_t method;
+    auto method = bus.new_method_call(service.c_str(), OP_DUMP_OBJ_PATH,
+                                      createInterface, function);
 
-    auto bus = sdbusplus::bus::new_default();
+    // dbus call arguments
+    std::map<std::string, std::variant<std::string, uint64_t>> createParams;
+    createParams["com.ibm.Dump.Create.CreateParameters.ErrorLogId"] =
+        uint64_t(dumpParameters.logId);
+    if (DumpType::SBE == dumpParameters.dumpType)
+    {
+        createParams["com.ibm.Dump.Create.CreateParameters.DumpType"] =
+            "com.ibm.Dump.Create.DumpType.SBE";
+        createParams["com.ibm.Dump.Create.CreateParameters.FailingUnitId"] =
+            dumpParameters.unitId;
+    }
+    method.append(createParams);
 
-    try
+    auto response = bus.call(method);
+
+    // reply will be type dbus::ObjectPath
+    return response.unpack<sdbusplus::object_path>();
+}
+
+/**
+ * @class DumpScheduler
+ *
+ * Requests a list of dumps and tracks all of the dumps in progress on
+ * one event loop, starting the next dump whenever one completes so
+ * that no more than a given number are in progress at a time.
+ */
+class DumpScheduler
+{
+  public:
+    DumpScheduler(const DumpScheduler&) = delete;
+    DumpScheduler& operator=(const DumpScheduler&) = delete;
+    DumpScheduler(DumpScheduler&&) = delete;
+    DumpScheduler& operator=(DumpScheduler&&) = delete;
+    ~DumpScheduler() = default;
+
+    /**
+     * @param[in] dumps Parameters for each dump request
+     * @param[in] limit The most dumps to have in progress at once
+     */
+    DumpScheduler(const std::vector<DumpParameters>& dumps, size_t limit) :
+        event(sdeventplus::Event::get_new()), bus(sdbusplus::bus::new_system()),
+        maxActive(std::max<size_t>(limit, 1)), monitors(dumps.size())
     {
-        std::string service = util::getService(bus, path, interface);
-        auto method =
-            bus.new_method_call(service.c_str(), path, interface, function);
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
 
-        // dbus call arguments
-        std::map<std::string, std::variant<std::string, uint64_t>> createParams;
-        createParams["com.ibm.Dump.Create.CreateParameters.ErrorLogId"] =
-            uint64_t(dumpParameters.logId);
-        if (DumpType::SBE == dumpParameters.dumpType)
+        for (const auto& dump : dumps)
         {
-            createParams["com.ibm.Dump.Create.CreateParameters.DumpType"] =
-                "com.ibm.Dump.Create.DumpType.SBE";
-            createParams["com.ibm.Dump.Create.CreateParameters.FailingUnitId"] =
-                dumpParameters.unitId;
+            results.push_back({dump, DumpStatus::Failed, {}});
         }
-        method.append(createParams);
+    }
 
-        auto response = bus.call(method);
+    /**
+     * Requests the dumps and waits for them all to complete or time out
+     *
+     * @return the result of each dump, in the order they were passed in
+     */
+    std::vector<DumpResult> run()
+    {
+        try
+        {
+            service = util::getService(OP_DUMP_OBJ_PATH, createInterface);
+        }
+        catch (const std::exception& e)
+        {
+            log<level::ERR>(
+                std::format("Dump manager not found, EXCEPTION={}", e.what())
+                    .c_str());
+            return results;
+        }
 
-        // reply will be type dbus::ObjectPath
-        auto reply = response.unpack<sdbusplus::object_path>();
+        startDumps();
+        if (active > 0)
+        {
+            event.loop();
+        }
 
-        // monitor dump progress
-        monitorDump(reply, dumpParameters.timeout);
+        return results;
     }
-    catch (const sdbusplus::exception_t& e)
+
+  private:
+    using Deadline = sdeventplus::source::Time<sdeventplus::ClockId::Monotonic>;
+
+    /**
+     * The signal match and deadline of one dump in progress
+     */
+    struct Monitor
     {
-        log<level::ERR>(std::format("D-Bus call createDump exception",
-                                    "OBJPATH={}, INTERFACE={}, EXCEPTION={}",
-                                    path, interface, e.what())
-                            .c_str());
-        constexpr auto ERROR_DUMP_DISABLED =
-            "xyz.openbmc_project.Dump.Create.Error.Disabled";
-        if (e.name() == ERROR_DUMP_DISABLED)
+        std::unique_ptr<sdbusplus::bus::match_t> match;
+        std::unique_ptr<Deadline> deadline;
+        bool done = false;
+    };
+
+    /**
+     * Starts dumps until the limit in progress is reached
+     */
+    void startDumps()
+    {
+        while ((active < maxActive) && (next < results.size()))
         {
-            // Dump is disabled, Skip the dump collection.
-            log<level::INFO>(
-                std::format("Dump is disabled on({}), skipping dump collection",
-                            dumpParameters.unitId)
-                    .c_str());
+            startDump(next++);
+        }
+    }
+
+    /**
+     * Requests a dump and starts monitoring it
+     *
+     * @param[in] index The dump to start
+     */
+    void startDump(size_t index)
+    {
+        auto& result = results[index];
+        auto& monitor = monitors[index];
+
+        try
+        {
+            result.path = createDump(bus, service, result.parameters);
         }
-        else
+        catch (const sdbusplus::exception_t& e)
         {
-            throw std::runtime_error(
-                "Error in invoking D-Bus createDump interface");
+            log<level::ERR>(std::format("D-Bus call createDump exception "
+                                        "OBJPATH={}, INTERFACE={}, "
+                                        "EXCEPTION={}",
+                                        OP_DUMP_OBJ_PATH, createInterface,
+                                        e.what())
+                                .c_str());
+            constexpr auto ERROR_DUMP_DISABLED =
+                "xyz.openbmc_project.Dump.Create.Error.Disabled";
+            if (e.name() == ERROR_DUMP_DISABLED)
+            {
+                // Dump is disabled, Skip the dump collection.
+                log<level::INFO>(
+                    std::format(
+                        "Dump is disabled on({}), skipping dump collection",
+                        result.parameters.unitId)
+                        .c_str());
+                result.status = DumpStatus::Disabled;
+            }
+            monitor.done = true;
+            return;
+        }
+
+        active++;
+
+        monitor.match = std::make_unique<sdbusplus::bus::match_t>(
+            bus,
+            sdbusplus::bus::match::rules::propertiesChanged(result.path,
+                                                            progressInterface),
+            [this, index](auto& msg) {
+                return dumpStatusChanged(msg, results[index].path,
+                                         [this, index](const std::string&) {
+                                             finish(index,
+                                                    DumpStatus::Completed);
+                                         });
+            });
+
+        monitor.deadline = std::make_unique<Deadline>(
+            event,
+            sdeventplus::Clock<sdeventplus::ClockId::Monotonic>(event).now() +
+                std::chrono::seconds(result.parameters.timeout),
+            std::chrono::milliseconds(1), [this, index](auto&, auto) {
+                log<level::ERR>(
+                    std::format("Dump progress status did not change to "
+                                "complete within the timeout interval, "
+                                "path={}",
+                                results[index].path)
+                        .c_str());
+                finish(index, DumpStatus::TimedOut);
+            });
+
+        // the dump may have finished before the match was added
+        auto status = getDumpStatus(bus, service, result.path);
+        if (status && isDumpDone(*status))
+        {
+            complete(index, DumpStatus::Completed);
         }
     }
-    catch (const std::exception& e)
+
+    /**
+     * Records the result of a dump in progress and stops monitoring it
+     *
+     * @param[in] index  The dump
+     * @param[in] status The result
+     */
+    void complete(size_t index, DumpStatus status)
+    {
+        auto& monitor = monitors[index];
+        if (monitor.done)
+        {
+            return;
+        }
+
+        monitor.done = true;
+        monitor.deadline->set_enabled(sdeventplus::source::Enabled::Off);
+        results[index].status = status;
+        active--;
+    }
+
+    /**
+     * Completes a dump, starts the next ones and stops the event loop
+     * when none are left
+     *
+     * @param[in] index  The dump
+     * @param[in] status The result
+     */
+    void finish(size_t index, DumpStatus status)
+    {
+        complete(index, status);
+        startDumps();
+
+        if (active == 0)
+        {
+            event.exit(0);
+        }
+    }
+
+    /** The event loop the dumps are tracked on */
+    sdeventplus::Event event;
+
+    /** The bus the dumps are requested and tracked on */
+    sdbusplus::bus_t bus;
+
+    /** The dump manager service */
+    std::string service;
+
+    /** The most dumps that may be in progress at once */
+    size_t maxActive;
+
+    /** The number of dumps in progress */
+    size_t active = 0;
+
+    /** The next dump to start */
+    size_t next = 0;
+
+    /** The result of each dump */
+    std::vector<DumpResult> results;
+
+    /** The monitor of each dump */
+    std::vector<Monitor> monitors;
+};
+
+std::vector<DumpResult> requestDumps(const std::vector<DumpParameters>& dumps,
+                                     size_t maxActive)
+{
+    DumpScheduler scheduler{dumps, maxActive};
+    return scheduler.run();
+}
+
+void requestDump(const DumpParameters& dumpParameters)
+{
+    auto results = requestDumps({dumpParameters}, 1);
+
+    if (results.front().status == DumpStatus::Failed)
     {
-        throw e;
+        throw std::runtime_error("Error in invoking D-Bus createDump interface");
     }
 }
 
@@ -1,4 +1,7 @@
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #pragma once
 
@@ -6,6 +9,7 @@ namespace openpower::phal::dump
 {
 
 constexpr auto SBE_DUMP_TIMEOUT = 4 * 60; // Timeout in seconds
+constexpr size_t SBE_DUMP_MAX_ACTIVE = 4;  // Dumps in progress at once
 
 /** @brief Dump types supported by dump request */
 enum class DumpType
@@ -22,6 +26,23 @@ struct DumpParameters
     DumpType dumpType;
 };
 
+/** @brief Result of a dump request */
+enum class DumpStatus
+{
+    Completed,
+    TimedOut,
+    Disabled,
+    Failed
+};
+
+/** @brief Structure for the result of one dump request */
+struct DumpResult
+{
+    DumpParameters parameters;
+    DumpStatus status;
+    std::string path;
+};
+
 /**
  * Request a dump from the dump manager
  *
@@ -32,4 +53,20 @@ struct DumpParameters
  */
 void requestDump(const DumpParameters& dumpParameters);
 
+/**
+ * Request several dumps from the dump manager
+ *
+ * Dumps are requested in order, with at most maxActive of them in
+ * progress at a time, and all of the dumps in progress are monitored
+ * together.  Each dump times out on its own, timeout seconds after it
+ * was requested.  Returns once every dump has completed, timed out or
+ * could not be requested.
+ *
+ * @param dumps Parameters for each dump request
+ * @param maxActive The most dumps to have in progress at once
+ * @return The result of each dump, in the same order as dumps
+ */
+std::vector<DumpResult> requestDumps(const std::vector<DumpParameters>& dumps,
+                                     size_t maxActive = SBE_DUMP_MAX_ACTIVE);
+
 } // namespace openpower::phal::dump
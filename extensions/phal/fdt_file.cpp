@@ -0,0 +1,167 @@
+#include "fdt_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace openpower::phal
+{
+
+namespace
+{
+
+constexpr uint32_t fdtMagic = 0xD00DFEED;
+constexpr size_t fdtHeaderSize = 40;
+
+constexpr uint32_t fdtBeginNode = 1;
+constexpr uint32_t fdtEndNode = 2;
+constexpr uint32_t fdtProp = 3;
+constexpr uint32_t fdtNop = 4;
+constexpr uint32_t fdtEnd = 9;
+
+uint32_t getBE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+size_t align4(size_t value)
+{
+    return (value + 3) & ~static_cast<size_t>(3);
+}
+
+} // namespace
+
+FdtFile::FdtFile(const std::filesystem::path& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::runtime_error{"Unable to open " + path.string() + ": " +
+                                 strerror(errno)};
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 ||
+        static_cast<size_t>(st.st_size) < fdtHeaderSize)
+    {
+        close(fd);
+        throw std::runtime_error{"Invalid devtree file " + path.string()};
+    }
+
+    size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    int savedErrno = errno;
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        throw std::runtime_error{"Unable to map " + path.string() + ": " +
+                                 strerror(savedErrno)};
+    }
+    data = static_cast<const uint8_t*>(map);
+
+    auto totalSize = getBE32(data + 4);
+    auto structOff = getBE32(data + 8);
+    auto stringsOff = getBE32(data + 12);
+    auto stringsSize = getBE32(data + 32);
+    auto structSize = getBE32(data + 36);
+
+    if (getBE32(data) != fdtMagic || totalSize > size ||
+        structOff > totalSize || structSize > totalSize - structOff ||
+        stringsOff > totalSize || stringsSize > totalSize - stringsOff)
+    {
+        munmap(map, size);
+        throw std::runtime_error{"Invalid devtree header in " + path.string()};
+    }
+
+    structs = {data + structOff, structSize};
+    strings = {data + stringsOff, stringsSize};
+}
+
+FdtFile::~FdtFile()
+{
+    munmap(const_cast<uint8_t*>(data), size);
+}
+
+std::string_view FdtFile::getString(std::span<const uint8_t> block,
+                                    size_t offset)
+{
+    if (offset >= block.size())
+    {
+        throw std::runtime_error{"Devtree string out of range"};
+    }
+
+    auto start = reinterpret_cast<const char*>(block.data() + offset);
+    auto length = strnlen(start, block.size() - offset);
+    if (offset + length == block.size())
+    {
+        throw std::runtime_error{"Devtree string not terminated"};
+    }
+
+    return {start, length};
+}
+
+FdtFile::Token FdtFile::next(size_t& pos) const
+{
+    while (true)
+    {
+        if (pos + 4 > structs.size())
+        {
+            throw std::runtime_error{"Devtree structure truncated"};
+        }
+
+        auto tag = getBE32(structs.data() + pos);
+        pos += 4;
+
+        switch (tag)
+        {
+            case fdtBeginNode:
+            {
+                auto name = getString(structs, pos);
+                pos += align4(name.size() + 1);
+                return {Token::Type::BeginNode, name, {}, 0};
+            }
+            case fdtEndNode:
+                return {Token::Type::EndNode, {}, {}, 0};
+            case fdtProp:
+            {
+                if (pos + 8 > structs.size())
+                {
+                    throw std::runtime_error{"Devtree structure truncated"};
+                }
+                auto length = getBE32(structs.data() + pos);
+                auto nameOff = getBE32(structs.data() + pos + 4);
+                auto name = getString(strings, nameOff);
+                pos += 8;
+
+                if (length > structs.size() - pos)
+                {
+                    throw std::runtime_error{"Devtree property truncated"};
+                }
+                Token token{Token::Type::Property, name,
+                            structs.subspan(pos, length),
+                            static_cast<size_t>(structs.data() + pos - data)};
+                pos += align4(length);
+                return token;
+            }
+            case fdtNop:
+                continue;
+            case fdtEnd:
+                pos -= 4;
+                return {Token::Type::End, {}, {}, 0};
+            default:
+                throw std::runtime_error{"Invalid devtree structure tag " +
+                                         std::to_string(tag)};
+        }
+    }
+}
+
+} // namespace openpower::phal
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace openpower::phal
+{
+
+/**
+ * @class FdtFile
+ *
+ * A read only, memory mapped flattened device tree file, such as the
+ * CEC devtree, walked directly without loading it into the devtree
+ * API.  Nothing is copied, so the names and values returned point into
+ * the mapping and are only valid while the object exists.
+ *
+ * The mapping is shared, so values written in place to the file, as
+ * the devtree API does for attributes, are seen through it.
+ */
+class FdtFile
+{
+  public:
+    /**
+     * One item of the devtree structure, in file order
+     */
+    struct Token
+    {
+        enum class Type
+        {
+            BeginNode,
+            EndNode,
+            Property,
+            End
+        };
+
+        Type type;
+
+        /** Node name for BeginNode, property name for Property */
+        std::string_view name;
+
+        /** Property value */
+        std::span<const uint8_t> value;
+
+        /** Offset of the property value in the file */
+        size_t offset;
+    };
+
+    FdtFile() = delete;
+    FdtFile(const FdtFile&) = delete;
+    FdtFile& operator=(const FdtFile&) = delete;
+    FdtFile(FdtFile&&) = delete;
+    FdtFile& operator=(FdtFile&&) = delete;
+
+    /**
+     * Constructor.
+     *
+     * Throws an exception if the file cannot be mapped or doesn't have
+     * a valid devtree header.
+     *
+     * @param[in] path - the devtree file
+     */
+    explicit FdtFile(const std::filesystem::path& path);
+
+    /**
+     * Destructor.
+     *
+     * Unmaps the file.
+     */
+    ~FdtFile();
+
+    /**
+     * Returns the whole file
+     */
+    std::span<const uint8_t> getData() const
+    {
+        return {data, size};
+    }
+
+    /**
+     * @brief Returns the next item of the structure.
+     *
+     * Start with pos 0 and keep calling until a Token::Type::End is
+     * returned.  NOPs are skipped.
+     *
+     * Throws an exception if the structure is malformed.
+     *
+     * @param[in,out] pos - the position in the structure
+     *
+     * @return the item at pos
+     */
+    Token next(size_t& pos) const;
+
+  private:
+    /**
+     * Returns the NUL terminated string at offset in the block
+     */
+    static std::string_view getString(std::span<const uint8_t> block,
+                                      size_t offset);
+
+    /** The mapping */
+    const uint8_t* data = nullptr;
+
+    /** The file size */
+    size_t size = 0;
+
+    /** The structure block */
+    std::span<const uint8_t> structs;
+
+    /** The strings block */
+    std::span<const uint8_t> strings;
+};
+
+} // namespace openpower::phal
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openpower
+{
+namespace pel
+{
+using FFDCData = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Binary FFDC to attach to a PEL as a Custom format FFDC file
+ */
+struct FFDCSection
+{
+    /** The FFDC sub type, identifies the data for parsers */
+    uint8_t subType;
+
+    /** The version of the data format */
+    uint8_t version;
+
+    /** The data */
+    std::vector<uint8_t> data;
+};
+
+using FFDCSections = std::vector<FFDCSection>;
+
+/**
+ * FFDC sub type of the SBE FFDC section, as libphal collects it
+ */
+constexpr uint8_t sbeFFDCSubType = 0xCB;
+
+/**
+ * FFDC sub type of the binary phal trace section,
+ * see TraceBuffer::serialize()
+ */
+constexpr uint8_t phalTraceSubType = 0xCC;
+
+/**
+ * FFDC sub type of the binary clock register section,
+ * see clock::Manager::addClockRegData()
+ */
+constexpr uint8_t clockRegsSubType = 0xCD;
+
+/**
+ * FFDC sub type of the binary clock samples section,
+ * see clock::Sampler::getSections()
+ */
+constexpr uint8_t clockSamplesSubType = 0xCE;
+
+} // namespace pel
+} // namespace openpower
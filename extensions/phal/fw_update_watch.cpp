@@ -4,18 +4,20 @@
 
 #include "common_utils.hpp"
 #include "create_pel.hpp"
-#include "pdbg_utils.hpp"
-
-#include <sys/stat.h>
-#include <sys/wait.h>
-#include <unistd.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <sdbusplus/exception.hpp>
 
+#include <cstdio>
 #include <filesystem>
 #include <format>
+#include <memory>
+
+extern "C"
+{
+#include <dtree.h>
+}
 
 namespace openpower
 {
@@ -134,43 +136,35 @@ void exportDevtree()
         fs::create_directory(expFile.parent_path());
     }
 
-    // Update PDBG_DTB value
-    openpower::phal::setDevtreeEnv();
-
-    // Update PDATA_INFODB value
-    openpower::phal::setPdataInfoDBEnv();
-
-    int status = 0;
-    pid_t pid = fork();
-    if (pid == 0)
+    // Export straight into the data file, in this process
+    std::unique_ptr<FILE, decltype(&fclose)> fpExport(
+        fopen(DEVTREE_EXP_FILE, "w"), &fclose);
+    if (!fpExport)
     {
-        std::string cmd("/usr/bin/attributes ");
-        cmd += "export ";
-        cmd += DEVTREE_EXPORT_FILTER_FILE;
-        cmd += " > ";
-        cmd += DEVTREE_EXP_FILE;
-        execl("/bin/sh", "sh", "-c", cmd.c_str(), 0);
-
-        auto error = errno;
-        log<level::ERR>(std::format("Error occurred during attributes function "
-                                    "execution, errno({})",
-                                    error)
-                            .c_str());
-        // Creating PEL at one place.
+        log<level::ERR>(
+            std::format("Failed to open export data file ({}) errno({})",
+                        DEVTREE_EXP_FILE, errno)
+                .c_str());
+        openpower::pel::createPEL(ERROR_DEVTREE_BACKUP);
+        return;
     }
-    else if (pid > 0)
+
+    auto ret = dtree_cronus_export(CEC_DEVTREE_RW_PATH, CEC_INFODB_PATH,
+                                   DEVTREE_EXPORT_FILTER_FILE, fpExport.get());
+    if ((fclose(fpExport.release()) != 0) && (ret == 0))
     {
-        waitpid(pid, &status, 0);
-        if (WEXITSTATUS(status))
-        {
-            log<level::ERR>("Failed to collect attribute export data");
-            openpower::pel::createPEL(ERROR_DEVTREE_BACKUP);
-        }
+        ret = errno;
     }
-    else
+
+    if (ret)
     {
-        log<level::ERR>("exportDevtree fork() failed");
-        std::runtime_error("exportDevtree fork() failed");
+        log<level::ERR>(
+            std::format("Failed({}) to collect attribute export data", ret)
+                .c_str());
+
+        // Don't leave partial data behind for the import
+        fs::remove(expFile);
+        openpower::pel::createPEL(ERROR_DEVTREE_BACKUP);
     }
 }
 
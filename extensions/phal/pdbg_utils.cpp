@@ -7,10 +7,15 @@ extern "C"
 
 #include "extensions/phal/pdbg_utils.hpp"
 #include "extensions/phal/phal_error.hpp"
+#include "targeting.hpp"
+#include "timing.hpp"
 
 #include <phosphor-logging/log.hpp>
 
 #include <format>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace openpower
 {
@@ -64,64 +69,160 @@ uint32_t probeTarget(struct pdbg_target* procTarget)
     return 0;
 }
 
-uint32_t getCFAM(struct pdbg_target* procTarget, const uint32_t reg,
-                 uint32_t& val)
+uint32_t ProcHandle::resolve()
 {
-    pdbg_target* fsiTarget = getFsiTarget(procTarget);
+    auto current = targeting::Targeting::getGeneration();
+    if (fsi != nullptr && generation == current)
+    {
+        return 0;
+    }
+
+    // The FSI devices may have changed, so open them again
+    release();
+
+    pdbg_target* fsiTarget = getFsiTarget(proc);
     if (nullptr == fsiTarget)
     {
-        log<level::ERR>("getCFAM: fsi path or target not found");
+        log<level::ERR>("fsi path or target not found");
         return -1;
     }
 
-    auto rc = probeTarget(procTarget);
+    auto rc = probeTarget(proc);
     if (rc)
     {
         // probe function logged details to journal
         return rc;
     }
 
-    rc = fsi_read(fsiTarget, reg, &val);
+    fsi = fsiTarget;
+    generation = current;
+    return 0;
+}
+
+uint32_t ProcHandle::getCFAM(const uint32_t reg, uint32_t& val)
+{
+    auto rc = resolve();
     if (rc)
     {
-        log<level::ERR>(
-            "failed to read input cfam", entry("RC=%u", rc),
-            entry("CFAM=0x%X", reg),
-            entry("FSI_TARGET_PATH=%s", pdbg_target_path(fsiTarget)));
+        return rc;
+    }
+
+    util::timing::Span span{"fsi_read"};
+    rc = fsi_read(fsi, reg, &val);
+    if (rc)
+    {
+        log<level::ERR>("failed to read input cfam", entry("RC=%u", rc),
+                        entry("CFAM=0x%X", reg),
+                        entry("FSI_TARGET_PATH=%s", pdbg_target_path(fsi)));
+
+        // The device may be gone, so find it again next time
+        release();
         return rc;
     }
     return 0;
 }
 
-uint32_t putCFAM(struct pdbg_target* procTarget, const uint32_t reg,
-                 const uint32_t val)
+uint32_t ProcHandle::getCFAMs(std::span<const uint32_t> regs,
+                              std::vector<uint32_t>& vals)
 {
-    pdbg_target* fsiTarget = getFsiTarget(procTarget);
-    if (nullptr == fsiTarget)
+    uint32_t firstRc = 0;
+
+    vals.clear();
+    vals.reserve(regs.size());
+
+    for (auto reg : regs)
     {
-        log<level::ERR>("putCFAM: fsi path or target not found");
-        return -1;
+        uint32_t val = 0;
+        auto rc = getCFAM(reg, val);
+        if (rc)
+        {
+            val = failedCFAMValue;
+            if (!firstRc)
+            {
+                firstRc = rc;
+            }
+        }
+        vals.push_back(val);
     }
+    return firstRc;
+}
 
-    auto rc = probeTarget(procTarget);
+uint32_t ProcHandle::putCFAM(const uint32_t reg, const uint32_t val)
+{
+    auto rc = resolve();
     if (rc)
     {
-        // probe function logged details to journal
         return rc;
     }
 
-    rc = fsi_write(fsiTarget, reg, val);
+    util::timing::Span span{"fsi_write"};
+    rc = fsi_write(fsi, reg, val);
     if (rc)
     {
-        log<level::ERR>(
-            "failed to write input cfam", entry("RC=%u", rc),
-            entry("CFAM=0x%X", reg),
-            entry("FSI_TARGET_PATH=%s", pdbg_target_path(fsiTarget)));
+        log<level::ERR>("failed to write input cfam", entry("RC=%u", rc),
+                        entry("CFAM=0x%X", reg),
+                        entry("FSI_TARGET_PATH=%s", pdbg_target_path(fsi)));
+
+        // The device may be gone, so find it again next time
+        release();
         return rc;
     }
     return 0;
 }
 
+void ProcHandle::release()
+{
+    // Only forget the target, releasing it in libpdbg would release the
+    // whole FSI subtree under libipl and libphal too
+    fsi = nullptr;
+}
+
+/**
+ * The handles created so far, by processor target
+ */
+static std::mutex handlesMutex;
+static std::map<struct pdbg_target*, std::unique_ptr<ProcHandle>> handles;
+
+ProcHandle& getProcHandle(struct pdbg_target* procTarget)
+{
+    std::lock_guard lock{handlesMutex};
+
+    auto& handle = handles[procTarget];
+    if (!handle)
+    {
+        handle = std::make_unique<ProcHandle>(procTarget);
+    }
+    return *handle;
+}
+
+void releaseProcHandles()
+{
+    std::lock_guard lock{handlesMutex};
+
+    for (auto& [target, handle] : handles)
+    {
+        handle->release();
+    }
+}
+
+uint32_t getCFAM(struct pdbg_target* procTarget, const uint32_t reg,
+                 uint32_t& val)
+{
+    return getProcHandle(procTarget).getCFAM(reg, val);
+}
+
+uint32_t getCFAMs(struct pdbg_target* procTarget,
+                  std::span<const uint32_t> regs, std::vector<uint32_t>& vals)
+{
+    return getProcHandle(procTarget).getCFAMs(regs, vals);
+}
+
+uint32_t putCFAM(struct pdbg_target* procTarget, const uint32_t reg,
+                 const uint32_t val)
+{
+    return getProcHandle(procTarget).putCFAM(reg, val);
+}
+
 void setDevtreeEnv()
 {
     // PDBG_DTB environment variable set to CEC device tree path
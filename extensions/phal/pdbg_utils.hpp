@@ -2,6 +2,10 @@
 
 #include <libipl.H>
 
+#include <cstdint>
+#include <span>
+#include <vector>
+
 extern "C"
 {
 #include <libpdbg.h>
@@ -12,6 +16,108 @@ namespace openpower
 namespace phal
 {
 
+/**
+ * The value getCFAMs() returns for a register it could not read
+ */
+constexpr uint32_t failedCFAMValue = 0xDEADBEEF;
+
+/**
+ * @class ProcHandle
+ *
+ * The FSI and PIB targets of a processor, found and probed on first
+ * use and then kept for all of its CFAM accesses.
+ *
+ * The targets are found and probed again after an FSI scan or a CFAM
+ * reset in this process, see targeting::Targeting::invalidate(), after
+ * an access fails, and after release().
+ */
+class ProcHandle
+{
+  public:
+    ProcHandle() = delete;
+    ProcHandle(const ProcHandle&) = delete;
+    ProcHandle& operator=(const ProcHandle&) = delete;
+    ProcHandle(ProcHandle&&) = delete;
+    ProcHandle& operator=(ProcHandle&&) = delete;
+    ~ProcHandle() = default;
+
+    /**
+     *  @param[in]  procTarget - Processor target to perform operations on
+     */
+    explicit ProcHandle(struct pdbg_target* procTarget) : proc(procTarget) {}
+
+    /**
+     *  @brief  Read a CFAM register
+     *
+     *  @param[in]  reg - The register address to read
+     *  @param[out] val - The value read from the register
+     *
+     *  @return 0 on success, non-0 on failure
+     */
+    uint32_t getCFAM(const uint32_t reg, uint32_t& val);
+
+    /**
+     *  @brief  Read several CFAM registers
+     *
+     *  Every register is read, even after one fails.
+     *
+     *  @param[in]  regs - The register addresses to read
+     *  @param[out] vals - The values read, in the order of regs, with
+     *                     failedCFAMValue for the ones that failed
+     *
+     *  @return 0 on success, the first failure otherwise
+     */
+    uint32_t getCFAMs(std::span<const uint32_t> regs,
+                      std::vector<uint32_t>& vals);
+
+    /**
+     *  @brief  Write a CFAM register
+     *
+     *  @param[in]  reg - The register address to write
+     *  @param[in]  val - The value to write to the register
+     *
+     *  @return 0 on success, non-0 on failure
+     */
+    uint32_t putCFAM(const uint32_t reg, const uint32_t val);
+
+    /**
+     *  @brief  Drop the targets, so the next access finds and probes
+     *          them again.  They stay open in libpdbg, which libipl and
+     *          libphal share.
+     */
+    void release();
+
+  private:
+    /**
+     *  @brief  Find and probe the targets, if not already done since
+     *          the last FSI scan or CFAM reset
+     *
+     *  @return 0 on success, non-0 on failure
+     */
+    uint32_t resolve();
+
+    /** The processor target */
+    struct pdbg_target* proc;
+
+    /** The FSI target, nullptr until resolved */
+    struct pdbg_target* fsi = nullptr;
+
+    /** The targeting generation the targets were resolved in */
+    uint64_t generation = 0;
+};
+
+/**
+ *  @brief  Get the handle of a processor target
+ *
+ *  The handle is created on the first call for a target, and kept
+ *  for the life of the process.
+ *
+ *  @param[in]  procTarget - Processor target
+ *
+ *  @return the handle
+ */
+ProcHandle& getProcHandle(struct pdbg_target* procTarget);
+
 /**
  *  @brief  Read the input CFAM register
  *
@@ -24,6 +130,28 @@ namespace phal
 uint32_t getCFAM(struct pdbg_target* procTarget, const uint32_t reg,
                  uint32_t& val);
 
+/**
+ *  @brief  Release the handles of all of the processors
+ *
+ *  A long running process doesn't see the FSI scans and CFAM resets
+ *  done by openpower-proc-control, so it calls this before each batch
+ *  of accesses.
+ */
+void releaseProcHandles();
+
+/**
+ *  @brief  Read the input CFAM registers
+ *
+ *  @param[in]  procTarget - Processor target to perform the operation on
+ *  @param[in]  regs - The register addresses to read
+ *  @param[out] vals - The values read, failedCFAMValue for the ones
+ *                     that failed
+ *
+ *  @return 0 on success, the first failure otherwise
+ */
+uint32_t getCFAMs(struct pdbg_target* procTarget,
+                  std::span<const uint32_t> regs, std::vector<uint32_t>& vals);
+
 /**
  *  @brief  Write the input CFAM register
  *
@@ -6,7 +6,9 @@ extern "C"
 #include "create_pel.hpp"
 #include "dump_utils.hpp"
 #include "extensions/phal/common_utils.hpp"
+#include "extensions/phal/proc_inventory.hpp"
 #include "phal_error.hpp"
+#include "trace_buffer.hpp"
 #include "util.hpp"
 
 #include <attributes_info.H>
@@ -197,11 +199,17 @@ namespace detail
 {
 using json = nlohmann::json;
 
-// keys need to be unique so using counter value to generate unique key
-static int counter = 0;
+// debug traces, kept until they are added to a PEL or reset
+static TraceBuffer traceBuffer;
 
-// list of debug traces
-static std::vector<std::pair<std::string, std::string>> traceLog;
+/**
+ * @brief Returns the collected debug traces as a binary PEL FFDC section
+ */
+static FFDCSections getTraceSections()
+{
+    return {{phalTraceSubType, TraceBuffer::formatVersion,
+             traceBuffer.serialize()}};
+}
 
 /**
  * @brief Process platform related boot failure
@@ -214,28 +222,31 @@ void processLogTraceCallback(void*, const char* fmt, va_list ap)
 {
     va_list vap;
     va_copy(vap, ap);
-    std::vector<char> logData(1 + std::vsnprintf(nullptr, 0, fmt, ap));
-    std::vsnprintf(logData.data(), logData.size(), fmt, vap);
+
+    char logData[TraceBuffer::maxLength];
+    auto length = std::vsnprintf(logData, sizeof(logData), fmt, ap);
+    if (length < 0)
+    {
+        va_end(vap);
+        return;
+    }
+
+    if (static_cast<size_t>(length) < sizeof(logData))
+    {
+        log<level::INFO>(logData);
+    }
+    else
+    {
+        // The trace buffer truncates long lines, but the journal gets
+        // all of it.
+        std::string logstr(length, '\0');
+        std::vsnprintf(logstr.data(), logstr.size() + 1, fmt, vap);
+        log<level::INFO>(logstr.c_str());
+    }
     va_end(vap);
-    std::string logstr(logData.begin(), logData.end());
-
-    log<level::INFO>(logstr.c_str());
-
-    char timeBuf[80];
-    time_t t = time(0);
-    tm myTm{};
-    gmtime_r(&t, &myTm);
-    strftime(timeBuf, 80, "%Y-%m-%d %H:%M:%S", &myTm);
-
-    // key values need to be unique for PEL
-    // TODO #openbmc/dev/issues/1563
-    // If written to Json no need to worry about unique KEY
-    std::stringstream str;
-    str << std::setfill('0');
-    str << "LOG" << std::setw(3) << counter;
-    str << " " << timeBuf;
-    traceLog.emplace_back(std::make_pair(str.str(), std::move(logstr)));
-    counter++;
+
+    traceBuffer.add(
+        {logData, std::min(static_cast<size_t>(length), sizeof(logData) - 1)});
 }
 
 /**
@@ -286,26 +297,20 @@ void processNonFunctionalBootProc()
     jsonCalloutDataList.emplace_back(std::move(jsonProcedCallout));
 
     // get primary processor
-    struct pdbg_target* procTarget;
-    pdbg_for_each_class_target("proc", procTarget)
-    {
-        if (openpower::phal::isPrimaryProc(procTarget))
-            break;
-        procTarget = nullptr;
-    }
+    const auto& inventory = openpower::phal::ProcInventory::get();
+    auto primary = inventory.getPrimary();
     // check valid primary processor is available
-    if (procTarget == nullptr)
+    if (primary == nullptr)
     {
         log<level::ERR>(
             "processNonFunctionalBootProc: fail to get primary processor");
     }
     else
     {
-        try
+        // Get location code information, already logged on failure
+        auto locationCode = inventory.getLocationCode(*primary);
+        if (!locationCode.empty())
         {
-            ATTR_LOCATION_CODE_Type locationCode = {'\0'};
-            // Get location code information
-            openpower::phal::pdbg::getLocationCode(procTarget, locationCode);
             json jsonProcCallout;
             jsonProcCallout["LocationCode"] = locationCode;
             jsonProcCallout["Deconfigured"] = false;
@@ -313,23 +318,11 @@ void processNonFunctionalBootProc()
             jsonProcCallout["Priority"] = "M";
             jsonCalloutDataList.emplace_back(std::move(jsonProcCallout));
         }
-        catch (const std::exception& e)
-        {
-            log<level::ERR>(std::format("getLocationCode({}): Exception({})",
-                                        pdbg_target_path(procTarget), e.what())
-                                .c_str());
-        }
     }
-    // Adding collected phal logs into PEL additional data
-    FFDCData pelAdditionalData;
-    for_each(
-        traceLog.begin(), traceLog.end(),
-        [&pelAdditionalData](std::pair<std::string, std::string>& ele) -> void {
-            pelAdditionalData.emplace_back(ele.first, ele.second);
-        });
+    // Adding collected phal logs into the PEL as binary FFDC
     openpower::pel::createErrorPEL(
         "org.open_power.PHAL.Error.NonFunctionalBootProc", jsonCalloutDataList,
-        pelAdditionalData, Severity::Error);
+        {}, Severity::Error, getTraceSections());
     // reset trace log and exit
     reset();
 }
@@ -402,16 +395,11 @@ void processClockInfoErrorHelper(FFDC* ffdc, const std::string& ffdc_prefix)
                      jsonCalloutDataList.emplace_back(jsonCalloutData);
                  });
 
-        // Adding collected phal logs into PEL additional data
-        for_each(traceLog.begin(), traceLog.end(),
-                 [&pelAdditionalData](
-                     std::pair<std::string, std::string>& ele) -> void {
-                     pelAdditionalData.emplace_back(ele.first, ele.second);
-                 });
-
+        // Adding collected phal logs into the PEL as binary FFDC
         openpower::pel::createErrorPEL("org.open_power.PHAL.Error.SpareClock",
                                        jsonCalloutDataList, pelAdditionalData,
-                                       Severity::Informational);
+                                       Severity::Informational,
+                                       getTraceSections());
     }
     catch (const std::exception& ex)
     {
@@ -531,16 +519,11 @@ void processPoweroffError(FFDC* ffdc, const std::string& ffdc_prefix)
                     .c_str());
         }
 
-        // Adding collected phal logs into PEL additional data
-        for_each(traceLog.begin(), traceLog.end(),
-                 [&pelAdditionalData](
-                     std::pair<std::string, std::string>& ele) -> void {
-                     pelAdditionalData.emplace_back(ele.first, ele.second);
-                 });
-
+        // Adding collected phal logs into the PEL as binary FFDC
         openpower::pel::createErrorPEL("org.open_power.PHAL.Error.Boot", {},
                                        pelAdditionalData,
-                                       Severity::Informational);
+                                       Severity::Informational,
+                                       getTraceSections());
     }
     catch (const std::exception& ex)
     {
@@ -759,13 +742,6 @@ void processBootErrorHelper(FFDC* ffdc, const std::string& ffdc_prefix)
                     .c_str());
         }
 
-        // Adding collected phal logs into PEL additional data
-        for_each(traceLog.begin(), traceLog.end(),
-                 [&pelAdditionalData](
-                     std::pair<std::string, std::string>& ele) -> void {
-                     pelAdditionalData.emplace_back(ele.first, ele.second);
-                 });
-
         // TODO: #ibm-openbmc/dev/issues/2595 : Once enabled this support,
         // callout details is not required to sort in H,M and L orders which
         // are expected by pel because, pel will take care for sorting callouts
@@ -791,9 +767,10 @@ void processBootErrorHelper(FFDC* ffdc, const std::string& ffdc_prefix)
                       // element
                       return true;
                   });
+        // Adding collected phal logs into the PEL as binary FFDC
         openpower::pel::createErrorPEL("org.open_power.PHAL.Error.Boot",
                                        jsonCalloutDataList, pelAdditionalData,
-                                       Severity::Error);
+                                       Severity::Error, getTraceSections());
     }
     catch (const std::exception& ex)
     {
@@ -866,27 +843,18 @@ void processSbeBootError()
 
     using namespace openpower::phal::sbe;
 
-    // To store phal trace and other additional data about ffdc.
+    // To store additional data about ffdc.
     FFDCData pelAdditionalData;
 
-    // Adding collected phal logs into PEL additional data
-    for_each(
-        traceLog.begin(), traceLog.end(),
-        [&pelAdditionalData](std::pair<std::string, std::string>& ele) -> void {
-            pelAdditionalData.emplace_back(ele.first, ele.second);
-        });
+    // Collected phal logs, added into the PEL as binary FFDC
+    auto traceSections = getTraceSections();
 
-    // reset the trace log and counter
+    // reset the trace log
     reset();
 
     // get primary processor to collect FFDC/Dump information.
-    struct pdbg_target* procTarget;
-    pdbg_for_each_class_target("proc", procTarget)
-    {
-        if (openpower::phal::isPrimaryProc(procTarget))
-            break;
-        procTarget = nullptr;
-    }
+    auto primary = openpower::phal::ProcInventory::get().getPrimary();
+    struct pdbg_target* procTarget = primary ? primary->target : nullptr;
     // check valid primary processor is available
     if (procTarget == nullptr)
     {
@@ -937,8 +905,8 @@ void processSbeBootError()
     uint32_t index = pdbg_target_index(procTarget);
     pelAdditionalData.emplace_back("SRC6", std::to_string(index << 16));
     // Create SBE Error with FFDC data.
-    auto logId =
-        createSbeErrorPEL(event, sbeError, pelAdditionalData, procTarget);
+    auto logId = createSbeErrorPEL(event, sbeError, pelAdditionalData,
+                                   procTarget, Severity::Error, traceSections);
 
     if (dumpIsRequired)
     {
@@ -963,11 +931,7 @@ void processGuardPartitionAccessError()
     // Adding collected phal logs into PEL additional data
     FFDCData pelAdditionalData;
 
-    for_each(
-        traceLog.begin(), traceLog.end(),
-        [&pelAdditionalData](std::pair<std::string, std::string>& ele) -> void {
-            pelAdditionalData.emplace_back(ele.first, ele.second);
-        });
+    traceBuffer.appendTo(pelAdditionalData);
 
     openpower::pel::createPEL("org.open_power.PHAL.Error.GuardPartitionAccess",
                               pelAdditionalData);
@@ -975,9 +939,8 @@ void processGuardPartitionAccessError()
 
 void reset()
 {
-    // reset the trace log and counter
-    traceLog.clear();
-    counter = 0;
+    // reset the trace log
+    traceBuffer.clear();
 }
 
 void pDBGLogTraceCallbackHelper(int, const char* fmt, va_list ap)
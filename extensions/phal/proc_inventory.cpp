@@ -0,0 +1,115 @@
+#include "extensions/phal/proc_inventory.hpp"
+
+#include "attributes_info.H"
+
+#include "extensions/phal/common_utils.hpp"
+#include "registration.hpp"
+
+#include <libphal.H>
+
+#include <phosphor-logging/log.hpp>
+
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
+
+namespace openpower::phal
+{
+
+using namespace phosphor::logging;
+
+ProcInventory::ProcInventory()
+{
+    struct pdbg_target* procTarget;
+    pdbg_for_each_class_target("proc", procTarget)
+    {
+        ProcInfo proc{procTarget,
+                      pdbg_target_index(procTarget),
+                      pdbg_target_path(procTarget),
+                      false,
+                      false,
+                      false,
+                      false,
+                      false};
+
+        ATTR_HWAS_STATE_Type hwasState;
+        if (DT_GET_PROP(ATTR_HWAS_STATE, procTarget, hwasState))
+        {
+            log<level::ERR>(
+                std::format("({})Could not read HWAS_STATE attribute",
+                            proc.path)
+                    .c_str());
+        }
+        else
+        {
+            proc.hwasValid = true;
+            proc.present = hwasState.present;
+            proc.functional = hwasState.functional;
+        }
+
+        try
+        {
+            proc.primary = isPrimaryProc(procTarget);
+            proc.primaryValid = true;
+        }
+        catch (const std::exception& e)
+        {
+            // Already logged, getPrimary() fails when it gets here
+        }
+
+        procs.push_back(std::move(proc));
+    }
+}
+
+std::string ProcInventory::getLocationCode(const ProcInfo& proc) const
+{
+    std::lock_guard lock{locationMutex};
+
+    auto it = locationCodes.find(proc.target);
+    if (it != locationCodes.end())
+    {
+        return it->second;
+    }
+
+    ATTR_LOCATION_CODE_Type locationCode;
+    memset(&locationCode, '\0', sizeof(locationCode));
+    try
+    {
+        openpower::phal::pdbg::getLocationCode(proc.target, locationCode);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>(std::format("getLocationCode({}): Exception({})",
+                                    proc.path, e.what())
+                            .c_str());
+    }
+
+    return locationCodes.emplace(proc.target, locationCode).first->second;
+}
+
+/**
+ * The snapshot returned by get(), until reset()
+ */
+static std::mutex sharedMutex;
+static std::unique_ptr<ProcInventory> shared;
+
+const ProcInventory& ProcInventory::get()
+{
+    std::lock_guard lock{sharedMutex};
+    if (!shared)
+    {
+        shared = std::make_unique<ProcInventory>();
+    }
+    return *shared;
+}
+
+void ProcInventory::reset()
+{
+    std::lock_guard lock{sharedMutex};
+    shared.reset();
+}
+
+REGISTER_RESET(procInventory, ProcInventory::reset)
+
+} // namespace openpower::phal
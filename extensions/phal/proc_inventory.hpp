@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include <libpdbg.h>
+}
+
+namespace openpower::phal
+{
+
+/**
+ * @brief What the procedures need to know about a processor
+ */
+struct ProcInfo
+{
+    /** The pdbg target */
+    struct pdbg_target* target;
+
+    /** pdbg_target_index() */
+    uint32_t index;
+
+    /** pdbg_target_path() */
+    std::string path;
+
+    /** If ATTR_HWAS_STATE could be read, present and functional are
+     *  false otherwise */
+    bool hwasValid;
+
+    /** ATTR_HWAS_STATE present */
+    bool present;
+
+    /** ATTR_HWAS_STATE functional */
+    bool functional;
+
+    /** If ATTR_PROC_MASTER_TYPE could be read, primary is false
+     *  otherwise */
+    bool primaryValid;
+
+    /** If it is the primary processor, see isPrimaryProc() */
+    bool primary;
+};
+
+/**
+ * @class ProcInventory
+ *
+ * A snapshot of the processors, read in a single pass over the pdbg
+ * targets, so that procedures don't each walk the device tree and read
+ * the same attributes again.
+ *
+ * The shared snapshot from get() is kept until reset(), which is called
+ * before every procedure, so a procedure run by the daemon doesn't see
+ * the processors as an earlier one found them.  Other long running
+ * services should construct their own when they need one.
+ *
+ * Location codes are only needed for callouts, so they are read on
+ * first use rather than with the rest.
+ */
+class ProcInventory
+{
+  public:
+    ProcInventory(const ProcInventory&) = delete;
+    ProcInventory& operator=(const ProcInventory&) = delete;
+    ProcInventory(ProcInventory&&) = delete;
+    ProcInventory& operator=(ProcInventory&&) = delete;
+    ~ProcInventory() = default;
+
+    /**
+     * Constructor.
+     *
+     * Reads the processors now.  pdbg must be initialized.
+     */
+    ProcInventory();
+
+    /**
+     * @brief Returns the snapshot shared by the process, read on the
+     *        first call.  pdbg must be initialized before then.
+     */
+    static const ProcInventory& get();
+
+    /**
+     * @brief Drops the shared snapshot, the next get() reads the
+     *        processors again.  References from get() become invalid.
+     */
+    static void reset();
+
+    /**
+     * @brief Returns every processor, in pdbg order
+     */
+    const std::vector<ProcInfo>& all() const
+    {
+        return procs;
+    }
+
+    /**
+     * @brief Returns the present processors
+     */
+    auto present() const
+    {
+        return procs | std::views::filter(
+                           [](const ProcInfo& proc) { return proc.present; });
+    }
+
+    /**
+     * @brief Returns the functional processors
+     */
+    auto functional() const
+    {
+        return procs | std::views::filter([](const ProcInfo& proc) {
+                   return proc.functional;
+               });
+    }
+
+    /**
+     * @brief Returns the primary processor, nullptr if there is none
+     *
+     * Like a walk with isPrimaryProc(), throws an exception if the type
+     * of a processor before the primary one couldn't be read.
+     */
+    const ProcInfo* getPrimary() const
+    {
+        for (const auto& proc : procs)
+        {
+            if (!proc.primaryValid)
+            {
+                throw std::runtime_error(
+                    "Attribute [ATTR_PROC_MASTER_TYPE] get failed");
+            }
+            if (proc.primary)
+            {
+                return &proc;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Returns the location code of a processor, read on the
+     *        first call
+     *
+     * @param[in] proc - the processor, from this snapshot
+     * @return the location code, empty if it couldn't be read
+     */
+    std::string getLocationCode(const ProcInfo& proc) const;
+
+  private:
+    /** The processors */
+    std::vector<ProcInfo> procs;
+
+    /** Guards locationCodes */
+    mutable std::mutex locationMutex;
+
+    /** The location codes read so far, by processor target */
+    mutable std::map<struct pdbg_target*, std::string> locationCodes;
+};
+
+} // namespace openpower::phal
@@ -0,0 +1,115 @@
+#include "trace_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+namespace openpower
+{
+namespace pel
+{
+
+void TraceBuffer::add(std::string_view line)
+{
+    auto number = next.fetch_add(1, std::memory_order_relaxed);
+    auto& record = records[number % capacity];
+
+    record.seq.store(2 * number + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.time = time(nullptr);
+    record.length = std::min(line.size(), maxLength);
+    std::memcpy(record.data, line.data(), record.length);
+
+    record.seq.store(2 * number + 2, std::memory_order_release);
+}
+
+std::vector<TraceBuffer::Line> TraceBuffer::getLines() const
+{
+    auto end = next.load(std::memory_order_acquire);
+    auto first = start.load(std::memory_order_relaxed);
+    auto begin = std::max(first, (end > capacity) ? end - capacity : 0);
+
+    std::vector<Line> lines;
+    lines.reserve(end - begin);
+
+    for (auto number = begin; number < end; number++)
+    {
+        const auto& record = records[number % capacity];
+        auto complete = 2 * number + 2;
+
+        if (record.seq.load(std::memory_order_acquire) != complete)
+        {
+            // Still being written, or already overwritten
+            continue;
+        }
+
+        Line line{number - first, record.time, {record.data, record.length}};
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.seq.load(std::memory_order_relaxed) != complete)
+        {
+            continue;
+        }
+
+        lines.push_back(std::move(line));
+    }
+
+    return lines;
+}
+
+void TraceBuffer::appendTo(
+    std::vector<std::pair<std::string, std::string>>& data) const
+{
+    auto lines = getLines();
+
+    data.reserve(data.size() + lines.size());
+
+    for (auto& line : lines)
+    {
+        char timeBuf[80];
+        tm myTm{};
+        gmtime_r(&line.time, &myTm);
+        strftime(timeBuf, sizeof(timeBuf), "%Y-%m-%d %H:%M:%S", &myTm);
+
+        // key values need to be unique for PEL
+        data.emplace_back(std::format("LOG{:03} {}", line.number, timeBuf),
+                          std::move(line.text));
+    }
+}
+
+std::vector<uint8_t> TraceBuffer::serialize() const
+{
+    auto lines = getLines();
+
+    std::vector<uint8_t> data;
+
+    auto put = [&data](uint64_t value, size_t size) {
+        for (size_t i = size; i > 0; i--)
+        {
+            data.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+        }
+    };
+
+    data.insert(data.end(), {'P', 'T', 'R', 'C', formatVersion, 0});
+    put(lines.size(), sizeof(uint16_t));
+
+    for (auto line = lines.rbegin(); line != lines.rend(); line++)
+    {
+        put(line->number, sizeof(uint32_t));
+        put(line->time, sizeof(uint64_t));
+        put(line->text.size(), sizeof(uint16_t));
+        data.insert(data.end(), line->text.begin(), line->text.end());
+    }
+
+    return data;
+}
+
+void TraceBuffer::clear()
+{
+    start.store(next.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+}
+
+} // namespace pel
+} // namespace openpower
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace openpower
+{
+namespace pel
+{
+
+/**
+ * @class TraceBuffer
+ *
+ * A fixed capacity ring of debug trace lines, used to hold the phal
+ * library traces until they are needed in a PEL.  Once it is full the
+ * oldest lines are overwritten, so memory use is bounded and adding a
+ * line never allocates.
+ *
+ * Lines are only turned into PEL additional data key/value pairs, or
+ * into a binary FFDC section, when they are read.  Any number of
+ * threads can add lines at the same time without locking.  A line
+ * being overwritten while it is read is skipped.
+ */
+class TraceBuffer
+{
+  public:
+    /**
+     * The number of lines kept
+     */
+    static constexpr size_t capacity = 256;
+
+    /**
+     * The longest line kept, longer ones are truncated
+     */
+    static constexpr size_t maxLength = 256;
+
+    /**
+     * The version of the serialize() format
+     */
+    static constexpr uint8_t formatVersion = 1;
+
+    TraceBuffer() = default;
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+    TraceBuffer(TraceBuffer&&) = delete;
+    TraceBuffer& operator=(TraceBuffer&&) = delete;
+    ~TraceBuffer() = default;
+
+    /**
+     * @brief Adds a line, time stamped with the current time
+     *
+     * @param[in] line - the trace line
+     */
+    void add(std::string_view line);
+
+    /**
+     * @brief Appends the lines added since the last clear, oldest
+     *        first, as PEL additional data.
+     *
+     * Each key is "LOGnnn <UTC time>", where nnn counts up from 0
+     * after every clear so that keys are unique.
+     *
+     * @param[out] data - the additional data to append to
+     */
+    void appendTo(std::vector<std::pair<std::string, std::string>>& data) const;
+
+    /**
+     * @brief Returns the lines added since the last clear in a compact
+     *        binary form, for a PEL FFDC section.
+     *
+     * All fields are big endian:
+     *   char magic[4]     "PTRC"
+     *   uint8 version     formatVersion
+     *   uint8 reserved
+     *   uint16 count      the number of lines that follow
+     * then for each line, newest first so that trimming the section
+     * drops the oldest lines:
+     *   uint32 number     counts up from 0 after every clear
+     *   uint64 time       seconds since the epoch
+     *   uint16 length
+     *   char text[length] not NUL terminated
+     *
+     * tools/phal-trace-decode.py decodes it.
+     *
+     * @return the serialized lines
+     */
+    std::vector<uint8_t> serialize() const;
+
+    /**
+     * @brief Forgets all of the lines added so far
+     */
+    void clear();
+
+  private:
+    /**
+     * A copy of one line, as returned by getLines()
+     */
+    struct Line
+    {
+        uint64_t number;
+        time_t time;
+        std::string text;
+    };
+
+    /**
+     * Returns a copy of the complete lines added since the last clear,
+     * oldest first, numbered from the last clear.
+     */
+    std::vector<Line> getLines() const;
+
+    /**
+     * One trace line.  seq is 2n+1 while line n is being written
+     * into it and 2n+2 once it is complete.
+     */
+    struct Record
+    {
+        std::atomic<uint64_t> seq{0};
+        time_t time = 0;
+        uint16_t length = 0;
+        char data[maxLength];
+    };
+
+    /**
+     * The lines, line n is in records[n % capacity]
+     */
+    std::array<Record, capacity> records;
+
+    /**
+     * The number of the next line to add
+     */
+    std::atomic<uint64_t> next{0};
+
+    /**
+     * The number of the first line added since the last clear
+     */
+    std::atomic<uint64_t> start{0};
+};
+
+} // namespace pel
+} // namespace openpower
@@ -0,0 +1,102 @@
+#include "memory_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <phosphor-logging/log.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+namespace openpower::util
+{
+using namespace phosphor::logging;
+
+MemoryFile::MemoryFile(const std::string& name, std::span<const uint8_t> data)
+{
+    create(name);
+
+    try
+    {
+        write(data);
+
+        if (sealed && (fcntl(fd, F_ADD_SEALS,
+                             F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE |
+                                 F_SEAL_SEAL) == -1))
+        {
+            throw std::runtime_error{
+                std::string{"Unable to seal memory file: "} + strerror(errno)};
+        }
+
+        if (lseek(fd, 0, SEEK_SET) == -1)
+        {
+            throw std::runtime_error{
+                std::string{"Unable to seek memory file: "} + strerror(errno)};
+        }
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+}
+
+MemoryFile::~MemoryFile()
+{
+    close(fd);
+}
+
+void MemoryFile::create(const std::string& name)
+{
+    fd = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd != -1)
+    {
+        sealed = true;
+        return;
+    }
+
+    log<level::WARNING>(
+        std::format("memfd_create failed, errno({}), using a temporary file",
+                    errno)
+            .c_str());
+
+    std::string templatePath =
+        std::filesystem::temp_directory_path() / (name + ".XXXXXX");
+
+    fd = mkostemp(templatePath.data(), O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::runtime_error{
+            std::string{"Unable to create memory file: "} + strerror(errno)};
+    }
+
+    // Only the descriptor is needed from here on
+    unlink(templatePath.c_str());
+}
+
+void MemoryFile::write(std::span<const uint8_t> data)
+{
+    while (!data.empty())
+    {
+        auto rc = ::write(fd, data.data(), data.size());
+        if (rc == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::runtime_error{
+                std::string{"Unable to write memory file: "} + strerror(errno)};
+        }
+
+        data = data.subspan(rc);
+    }
+}
+
+} // namespace openpower::util
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace openpower::util
+{
+
+/**
+ * @class MemoryFile
+ *
+ * An anonymous, read only file holding some data, used to hand the
+ * data to another process by file descriptor, for example as a PEL
+ * FFDC file passed over D-Bus as a unix_fd.
+ *
+ * The file is created with memfd_create() and sealed so that it can no
+ * longer be written, grown or shrunk.  If the kernel does not support
+ * memfd_create() it falls back to a file in the temporary directory
+ * that is unlinked as soon as it is created.  Either way nothing is
+ * left in the file system, and the file goes away once the last
+ * descriptor to it is closed.
+ *
+ * The file offset is left at the start of the data.
+ */
+class MemoryFile
+{
+  public:
+    MemoryFile() = delete;
+    MemoryFile(const MemoryFile&) = delete;
+    MemoryFile& operator=(const MemoryFile&) = delete;
+    MemoryFile(MemoryFile&&) = delete;
+    MemoryFile& operator=(MemoryFile&&) = delete;
+
+    /**
+     * Constructor.
+     *
+     * Throws an exception if the file cannot be created or written.
+     *
+     * @param[in] name - the name of the file, only used for debug
+     * @param[in] data - the contents of the file
+     */
+    MemoryFile(const std::string& name, std::span<const uint8_t> data);
+
+    /**
+     * Constructor.
+     *
+     * @param[in] name - the name of the file, only used for debug
+     * @param[in] data - the contents of the file
+     */
+    MemoryFile(const std::string& name, const std::string& data) :
+        MemoryFile(name,
+                   {reinterpret_cast<const uint8_t*>(data.data()), data.size()})
+    {}
+
+    /**
+     * Destructor.
+     *
+     * Closes the file descriptor.
+     */
+    ~MemoryFile();
+
+    /**
+     * Returns the file descriptor
+     */
+    int getFD() const
+    {
+        return fd;
+    }
+
+    /**
+     * Returns if the contents are sealed against changes, which is
+     * only false for the temporary directory fallback.
+     */
+    bool isSealed() const
+    {
+        return sealed;
+    }
+
+  private:
+    /**
+     * Creates the file, with memfd_create() if possible.
+     *
+     * @param[in] name - the name of the file
+     */
+    void create(const std::string& name);
+
+    /**
+     * Writes all of the data to the file.
+     *
+     * @param[in] data - the contents of the file
+     */
+    void write(std::span<const uint8_t> data);
+
+    /**
+     * The file descriptor
+     */
+    int fd = -1;
+
+    /**
+     * If the contents are sealed
+     */
+    bool sealed = false;
+};
+
+} // namespace openpower::util
@@ -26,41 +26,156 @@ extern "C"
 #include <phosphor-logging/elog.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <chrono>
+#include <string_view>
+#include <vector>
+
 namespace openpower
 {
 namespace proc
 {
 
+const sdbusplus::vtable_t NMI::timingVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("StopDuration", "t", NMI::getTiming,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("SResetDuration", "t", NMI::getTiming,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("FallbackCount", "u", NMI::getTiming,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end()};
+
 NMI::NMI(sdbusplus::bus_t& bus, const char* path) :
-    Interface(bus, path), bus(bus), objectPath(path)
+    Interface(bus, path), bus(bus), objectPath(path),
+    timing(bus, path, timingInterface, timingVtable, this)
 {}
 
+int NMI::getTiming(sd_bus*, const char*, const char*, const char* property,
+                   sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto nmi = static_cast<NMI*>(context);
+    std::string_view name{property};
+
+    if (name == "StopDuration")
+    {
+        return sd_bus_message_append(reply, "t", nmi->stopDuration);
+    }
+    if (name == "SResetDuration")
+    {
+        return sd_bus_message_append(reply, "t", nmi->sresetDuration);
+    }
+    return sd_bus_message_append(reply, "u", nmi->fallbackCount);
+}
+
+/*  @brief Stop the threads of a processor one at a time.
+ *  @param[in] proc - the processor
+ *  @return true if all of its threads are stopped
+ */
+static bool stopEachThread(struct pdbg_target* proc)
+{
+    struct pdbg_target* target;
+
+    pdbg_for_each_target("thread", proc, target)
+    {
+        if (pdbg_target_probe(target) != PDBG_TARGET_ENABLED)
+            continue;
+
+        if (thread_stop(target) < 0 || !thread_status(target).quiesced)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*  @brief Check that every enabled thread of a processor is quiesced.
+ *  @param[in] proc - the processor
+ *  @return true if all of its threads are stopped
+ */
+static bool isQuiesced(struct pdbg_target* proc)
+{
+    struct pdbg_target* target;
+
+    pdbg_for_each_target("thread", proc, target)
+    {
+        if (pdbg_target_probe(target) != PDBG_TARGET_ENABLED)
+            continue;
+
+        if (!thread_status(target).quiesced)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 void NMI::nmi()
 {
     using namespace phosphor::logging;
+    using namespace std::chrono;
     using InternalFailure =
         sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
 
     struct pdbg_target* target;
+    std::vector<struct pdbg_target*> procs;
 
-    pdbg_for_each_class_target("thread", target)
+    pdbg_for_each_class_target("proc", target)
     {
         if (pdbg_target_probe(target) != PDBG_TARGET_ENABLED)
             continue;
 
-        if (thread_stop(target) < 0 || !thread_status(target).quiesced)
+        procs.push_back(target);
+    }
+
+    auto start = steady_clock::now();
+
+    // One chip-op per processor, one processor at a time as libpdbg
+    // isn't thread safe.  thread_sreset_all() below relies on the
+    // thread state pdbg keeps, so this has to run in this process.
+    bool stopped = true;
+    fallbackCount = 0;
+    for (auto proc : procs)
+    {
+        if ((thread_stop_proc(proc) >= 0) && isQuiesced(proc))
         {
-            log<level::ERR>("Failed to stop all threads");
-            report<InternalFailure>();
-            return;
+            continue;
+        }
+
+        log<level::WARNING>(
+            "Failed to stop the processor threads, stopping each thread",
+            entry("PROC=%d", pdbg_target_index(proc)));
+        fallbackCount++;
+        if (!stopEachThread(proc))
+        {
+            stopped = false;
+            break;
         }
     }
 
-    if (thread_sreset_all() < 0)
+    stopDuration = duration_cast<microseconds>(steady_clock::now() - start)
+                       .count();
+    sresetDuration = 0;
+
+    if (!stopped)
     {
-        log<level::ERR>("Failed to sreset all threads");
+        log<level::ERR>("Failed to stop all threads");
         report<InternalFailure>();
     }
+    else
+    {
+        start = steady_clock::now();
+        if (thread_sreset_all() < 0)
+        {
+            log<level::ERR>("Failed to sreset all threads");
+            report<InternalFailure>();
+        }
+        sresetDuration =
+            duration_cast<microseconds>(steady_clock::now() - start).count();
+    }
+
+    timing.property_changed("StopDuration");
+    timing.property_changed("SResetDuration");
+    timing.property_changed("FallbackCount");
 }
 } // namespace proc
 } // namespace openpower
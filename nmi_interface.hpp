@@ -1,9 +1,14 @@
 #pragma once
 
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
 #include <sdbusplus/server/object.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <xyz/openbmc_project/Control/Host/NMI/server.hpp>
 
+#include <cstdint>
+#include <string>
+
 namespace openpower
 {
 namespace proc
@@ -12,6 +17,9 @@ namespace proc
 using Base = sdbusplus::xyz::openbmc_project::Control::Host::server::NMI;
 using Interface = sdbusplus::server::object_t<Base>;
 
+/** @brief Interface with the timing of the last NMI, on the NMI object */
+constexpr auto timingInterface = "org.open_power.Control.Host.NMI.Timing";
+
 /*  @class NMI
  *  @brief Implementation of NMI (Soft Reset)
  */
@@ -32,15 +40,40 @@ class NMI : public Interface
     NMI(sdbusplus::bus_t& bus, const char* path);
 
     /*  @brief trigger stop followed by soft reset.
+     *
+     *  The threads are stopped with one chip-op per processor, and
+     *  must all be quiesced after it.  A processor that fails either
+     *  falls back to stopping its threads one at a time.
      */
     void nmi() override;
 
   private:
+    /*  @brief D-Bus property getter for the timing interface.
+     */
+    static int getTiming(sd_bus* bus, const char* path, const char* interface,
+                         const char* property, sd_bus_message* reply,
+                         void* context, sd_bus_error* error);
+
+    /** @brief timing interface vtable */
+    static const sdbusplus::vtable_t timingVtable[];
+
     /** @brief sdbus handle */
     sdbusplus::bus_t& bus;
 
     /** @brief object path */
     std::string objectPath;
+
+    /** @brief how long stopping the threads took, in microseconds */
+    uint64_t stopDuration = 0;
+
+    /** @brief how long the soft reset took, in microseconds */
+    uint64_t sresetDuration = 0;
+
+    /** @brief processors that had their threads stopped one at a time */
+    uint32_t fallbackCount = 0;
+
+    /** @brief the timing interface, exporting the values above */
+    sdbusplus::server::interface_t timing;
 };
 
 } // namespace proc
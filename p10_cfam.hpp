@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 namespace openpower
 {
 namespace cfam
@@ -10,6 +13,12 @@ namespace p10
 static constexpr uint16_t P10_ROOT_CTRL8 = 0x2818;
 static constexpr uint16_t P10_SCRATCH_REG_12 = 0x2983;
 
+/**
+ * Registers that the hardware, SBE or host firmware can change behind
+ * our back.  These are never served from the shadow register cache.
+ */
+static constexpr std::array P10_VOLATILE_REGS = {P10_SCRATCH_REG_12};
+
 } // namespace p10
 } // namespace cfam
 } // namespace openpower
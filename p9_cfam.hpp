@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 namespace openpower
 {
 namespace cfam
@@ -23,6 +26,19 @@ static constexpr uint16_t P9_HB_MBX5_REG = 0x283C;
 static constexpr uint16_t P9_SCRATCH_REGISTER_8 = 0x283F;
 static constexpr uint16_t P9_ROOT_CTRL8 = 0x2918;
 static constexpr uint16_t P9_ROOT_CTRL1_CLEAR = 0x2931;
+
+/**
+ * Registers that the hardware, SBE or host firmware can change behind
+ * our back.  These are never served from the shadow register cache.
+ */
+static constexpr std::array P9_VOLATILE_REGS = {
+    P9_FSI2PIB_CHIPID,
+    P9_FSI2PIB_INTERRUPT,
+    P9_SBE_CTRL_STATUS,
+    P9_SBE_MSG_REGISTER,
+    P9_HB_MBX5_REG,
+    P9_SCRATCH_REGISTER_8,
+};
 } // namespace p9
 } // namespace cfam
 } // namespace openpower
@@ -0,0 +1,300 @@
+#include "parallel.hpp"
+
+#include "timing.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <phosphor-logging/log.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <system_error>
+#include <thread>
+
+namespace openpower
+{
+namespace util
+{
+
+using namespace phosphor::logging;
+
+std::vector<std::exception_ptr>
+    runParallel(size_t count, const std::function<void(size_t)>& func,
+                size_t maxWorkers)
+{
+    std::vector<std::exception_ptr> errors(count);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (auto index = next++; index < count; index = next++)
+        {
+            try
+            {
+                func(index);
+            }
+            catch (...)
+            {
+                errors[index] = std::current_exception();
+            }
+        }
+    };
+
+    auto workers = std::min(count, std::max<size_t>(maxWorkers, 1));
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 1; i < workers; i++)
+        {
+            try
+            {
+                threads.emplace_back(worker);
+            }
+            catch (const std::system_error& e)
+            {
+                // The threads that did start, and this one, will
+                // pick up the remaining calls.
+                log<level::WARNING>("Failed to start a worker thread",
+                                    entry("ERROR=%s", e.what()));
+                break;
+            }
+        }
+
+        worker();
+    }
+
+    return errors;
+}
+
+namespace detail
+{
+
+/**
+ * A child started by runInChildren()
+ */
+struct Child
+{
+    /** The index of the call it is making */
+    size_t index;
+
+    /** Its process id */
+    pid_t pid;
+
+    /** The read end of the pipe it writes its result to */
+    int fd;
+
+    /** What it wrote so far */
+    std::vector<uint8_t> data;
+};
+
+/**
+ * Runs func(index) in the child and exits, writing the result to fd.
+ * Exits with _exit() so the parent's atexit handlers and static
+ * destructors don't run twice.
+ */
+[[noreturn]] static void
+    runChild(size_t index,
+             const std::function<std::vector<uint8_t>(size_t)>& func, int fd)
+{
+    std::vector<uint8_t> data;
+    try
+    {
+        data = func(index);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Child process call failed",
+                        entry("INDEX=%zu", index), entry("ERROR=%s", e.what()));
+        _exit(EXIT_FAILURE);
+    }
+    catch (...)
+    {
+        log<level::ERR>("Child process call failed",
+                        entry("INDEX=%zu", index));
+        _exit(EXIT_FAILURE);
+    }
+
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto rc = write(fd, data.data() + written, data.size() - written);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            _exit(EXIT_FAILURE);
+        }
+        written += rc;
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * Waits for a child that closed its pipe, returning true if it exited
+ * normally with status 0.
+ */
+static bool reapChild(const Child& child)
+{
+    int status = 0;
+    while (waitpid(child.pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS))
+    {
+        return true;
+    }
+
+    if (WIFSIGNALED(status))
+    {
+        log<level::ERR>("Child process crashed",
+                        entry("INDEX=%zu", child.index),
+                        entry("SIGNAL=%d", WTERMSIG(status)));
+    }
+    return false;
+}
+
+std::vector<std::optional<std::vector<uint8_t>>> runInChildren(
+    size_t count, const std::function<std::vector<uint8_t>(size_t)>& func,
+    size_t maxChildren, std::chrono::milliseconds timeout)
+{
+    using namespace std::chrono;
+
+    std::vector<std::optional<std::vector<uint8_t>>> results(count);
+    std::vector<Child> children;
+    auto deadline = steady_clock::now() + timeout;
+    maxChildren = std::max<size_t>(maxChildren, 1);
+
+    size_t next = 0;
+    while ((next < count) || !children.empty())
+    {
+        auto now = steady_clock::now();
+
+        // Start as many of the remaining calls as allowed
+        while ((next < count) && (children.size() < maxChildren) &&
+               (now < deadline))
+        {
+            auto index = next++;
+
+            int fds[2];
+            if (pipe2(fds, O_CLOEXEC) != 0)
+            {
+                log<level::ERR>("Failed to create a child process pipe",
+                                entry("INDEX=%zu", index),
+                                entry("ERRNO=%d", errno));
+                continue;
+            }
+
+            pid_t pid = 0;
+            {
+                timing::Span span{"fork"};
+                pid = fork();
+                if (pid == 0)
+                {
+                    close(fds[0]);
+                    runChild(index, func, fds[1]);
+                }
+            }
+
+            close(fds[1]);
+            if (pid < 0)
+            {
+                log<level::ERR>("Failed to fork a child process",
+                                entry("INDEX=%zu", index),
+                                entry("ERRNO=%d", errno));
+                close(fds[0]);
+                continue;
+            }
+
+            children.push_back({index, pid, fds[0], {}});
+        }
+
+        if (children.empty())
+        {
+            break;
+        }
+
+        if (now >= deadline)
+        {
+            for (auto& child : children)
+            {
+                log<level::ERR>("Child process did not finish in time, "
+                                "killing it",
+                                entry("INDEX=%zu", child.index));
+                kill(child.pid, SIGKILL);
+                close(child.fd);
+                reapChild(child);
+            }
+            children.clear();
+            break;
+        }
+
+        // Covers the wait for the children and collecting their results
+        timing::Span span{"child wait"};
+
+        std::vector<pollfd> fds;
+        for (const auto& child : children)
+        {
+            fds.push_back({child.fd, POLLIN, 0});
+        }
+
+        auto wait = duration_cast<milliseconds>(deadline - now).count() + 1;
+        if (poll(fds.data(), fds.size(), static_cast<int>(wait)) < 0)
+        {
+            if (errno != EINTR)
+            {
+                // Can't wait for them any more, so kill them
+                log<level::ERR>("poll on child processes failed",
+                                entry("ERRNO=%d", errno));
+                deadline = now;
+            }
+            continue;
+        }
+
+        for (size_t i = fds.size(); i > 0; i--)
+        {
+            auto& child = children[i - 1];
+            if (fds[i - 1].revents == 0)
+            {
+                continue;
+            }
+
+            uint8_t buffer[256];
+            auto rc = read(child.fd, buffer, sizeof(buffer));
+            if (rc > 0)
+            {
+                child.data.insert(child.data.end(), buffer, buffer + rc);
+                continue;
+            }
+            if ((rc < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+
+            // End of file, the child exited
+            close(child.fd);
+            if (reapChild(child))
+            {
+                results[child.index] = std::move(child.data);
+            }
+            children.erase(children.begin() + (i - 1));
+        }
+    }
+
+    return results;
+}
+
+} // namespace detail
+
+} // namespace util
+} // namespace openpower
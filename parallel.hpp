@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace openpower
+{
+namespace util
+{
+
+/**
+ * Runs func(0) through func(count - 1) on up to maxWorkers threads at
+ * a time, the calling thread included, and waits for all of them.
+ *
+ * The calls are handed out in index order to whichever thread is free,
+ * so a slow call does not hold up the ones after it.  An exception
+ * thrown by one call does not stop the others.  If a thread cannot be
+ * started the threads that did start pick up its share.
+ *
+ * @param[in] count - the number of calls to make
+ * @param[in] func - the callable, passed the index of the call
+ * @param[in] maxWorkers - the maximum number of threads to use
+ *
+ * @return the exception thrown by each call, by index, null for
+ *         the calls that returned normally
+ */
+std::vector<std::exception_ptr>
+    runParallel(size_t count, const std::function<void(size_t)>& func,
+                size_t maxWorkers);
+
+namespace detail
+{
+
+/**
+ * The untyped runInChildren(), each result is passed back as bytes
+ */
+std::vector<std::optional<std::vector<uint8_t>>> runInChildren(
+    size_t count, const std::function<std::vector<uint8_t>(size_t)>& func,
+    size_t maxChildren, std::chrono::milliseconds timeout);
+
+/**
+ * The fixed size part of a runInChildren() result, and if it also
+ * carries variable size data
+ */
+template <typename Result>
+struct ChildResult
+{
+    using Fixed = Result;
+    static constexpr bool hasData = false;
+};
+
+template <typename Fixed_>
+struct ChildResult<std::pair<Fixed_, std::vector<uint8_t>>>
+{
+    using Fixed = Fixed_;
+    static constexpr bool hasData = true;
+};
+
+} // namespace detail
+
+/**
+ * Runs func(0) through func(count - 1) each in its own forked child
+ * process, up to maxChildren at a time, and waits for them.
+ *
+ * This is the parallel loop to use around libpdbg and libphal, which
+ * are not thread safe.  Each child works on its own copy of their
+ * state, so probe every target the calls use before calling this,
+ * both to not probe them once per child and so the parent sees them
+ * probed.  The children's D-Bus connections are their own too, see
+ * getBus().
+ *
+ * What func returns in the child is passed back through a pipe, so it
+ * must be trivially copyable, or a std::pair of a trivially copyable
+ * value and a std::vector<uint8_t> for data whose size varies, such as
+ * FFDC.  Children still running when the timeout expires are killed,
+ * and calls not started by then are not made.
+ *
+ * @param[in] count - the number of calls to make
+ * @param[in] func - the callable, passed the index of the call
+ * @param[in] maxChildren - the maximum number of children at a time
+ * @param[in] timeout - how long to wait for all of the calls
+ *
+ * @return the result of each call, by index, empty for the calls that
+ *         threw, crashed, were killed or never started
+ */
+template <typename Func>
+auto runInChildren(size_t count, Func&& func, size_t maxChildren,
+                   std::chrono::milliseconds timeout)
+{
+    using Result = std::invoke_result_t<Func&, size_t>;
+    using Fixed = typename detail::ChildResult<Result>::Fixed;
+    constexpr bool hasData = detail::ChildResult<Result>::hasData;
+    static_assert(std::is_trivially_copyable_v<Fixed>);
+
+    auto data = detail::runInChildren(
+        count,
+        [&func](size_t index) {
+            Result result = func(index);
+            std::vector<uint8_t> bytes(sizeof(Fixed));
+            if constexpr (hasData)
+            {
+                std::memcpy(bytes.data(), &result.first, sizeof(Fixed));
+                bytes.insert(bytes.end(), result.second.begin(),
+                             result.second.end());
+            }
+            else
+            {
+                std::memcpy(bytes.data(), &result, sizeof(Fixed));
+            }
+            return bytes;
+        },
+        maxChildren, timeout);
+
+    std::vector<std::optional<Result>> results(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!data[i] || (data[i]->size() < sizeof(Fixed)) ||
+            (!hasData && (data[i]->size() != sizeof(Fixed))))
+        {
+            continue;
+        }
+
+        results[i].emplace();
+        if constexpr (hasData)
+        {
+            std::memcpy(&results[i]->first, data[i]->data(), sizeof(Fixed));
+            results[i]->second.assign(data[i]->begin() + sizeof(Fixed),
+                                      data[i]->end());
+        }
+        else
+        {
+            std::memcpy(&*results[i], data[i]->data(), sizeof(Fixed));
+        }
+    }
+
+    return results;
+}
+
+} // namespace util
+} // namespace openpower
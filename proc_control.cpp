@@ -13,30 +13,52 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "config.h"
+
 #include "registration.hpp"
+#include "targeting.hpp"
+#include "timing.hpp"
+
+#include <sys/stat.h>
 
 #include <org/open_power/Proc/FSI/error.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <xyz/openbmc_project/Common/Device/error.hpp>
 #include <xyz/openbmc_project/Common/File/error.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <vector>
 
 using namespace openpower::util;
+using namespace phosphor::logging;
 
 namespace common_error = sdbusplus::xyz::openbmc_project::Common::Error;
 namespace device_error = sdbusplus::xyz::openbmc_project::Common::Device::Error;
 namespace file_error = sdbusplus::xyz::openbmc_project::Common::File::Error;
 namespace fsi_error = sdbusplus::org::open_power::Proc::FSI::Error;
 
+constexpr auto daemonBusName = "org.open_power.Proc.Control";
+constexpr auto daemonObjectPath = "/org/open_power/proc/control";
+constexpr auto daemonInterface = "org.open_power.Proc.Control";
+constexpr auto daemonRestartingError =
+    "org.open_power.Proc.Control.Error.Restarting";
+
 void usage(char** argv, const ProcedureMap& procedures)
 {
     std::cerr << "Usage: " << argv[0] << " [action]\n";
+    std::cerr << "       " << argv[0] << " --daemon\n";
     std::cerr << "   actions:\n";
 
     for (const auto& p : procedures)
@@ -45,30 +67,23 @@ void usage(char** argv, const ProcedureMap& procedures)
     }
 }
 
-int main(int argc, char** argv)
+/**
+ * Runs a procedure, committing an error log for any of the
+ * known errors it fails with.  The run is timed, see timing.hpp.
+ *
+ * @param[in] name - the procedure name
+ * @param[in] procedure - the procedure to run
+ *
+ * @return int - 0 on success, -1 on failure
+ */
+int runProcedure(const std::string& name, const ProcedureFunction& procedure)
 {
-    using namespace phosphor::logging;
-    const ProcedureMap& procedures = Registration::getProcedures();
-
-    if (argc != 2)
-    {
-        usage(argv, procedures);
-        return -1;
-    }
-
-    std::string action{argv[1]};
-
-    auto procedure = procedures.find(action);
-
-    if (procedure == procedures.end())
-    {
-        usage(argv, procedures);
-        return -1;
-    }
+    timing::Procedure timer{name, TIMING_TRACE_DIR};
 
     try
     {
-        procedure->second();
+        Registration::reset();
+        procedure();
     }
     catch (const file_error::Seek& e)
     {
@@ -113,3 +128,253 @@ int main(int argc, char** argv)
 
     return 0;
 }
+
+/**
+ * Identifies the version of the device tree file that the pdbg and
+ * libekb state kept by the daemon was built from.
+ */
+struct DevtreeVersion
+{
+    bool exists = false;
+    dev_t dev = 0;
+    ino_t ino = 0;
+    timespec mtime{};
+
+    bool operator==(const DevtreeVersion& other) const
+    {
+        return (exists == other.exists) && (dev == other.dev) &&
+               (ino == other.ino) && (mtime.tv_sec == other.mtime.tv_sec) &&
+               (mtime.tv_nsec == other.mtime.tv_nsec);
+    }
+};
+
+/**
+ * Returns the current version of the r/w device tree file
+ */
+DevtreeVersion getDevtreeVersion()
+{
+    struct stat st{};
+    if (stat(CEC_DEVTREE_RW_PATH, &st) != 0)
+    {
+        return {};
+    }
+
+    return {true, st.st_dev, st.st_ino, st.st_mtim};
+}
+
+/**
+ * The device tree version and the FSI targeting generation the
+ * daemon's pdbg state matches, set when the daemon starts.
+ */
+DevtreeVersion daemonDevtree;
+uint64_t daemonGeneration = 0;
+
+/**
+ * Set by callProcedure when the device tree or the FSI topology
+ * changed, so the daemon exits to be restarted with fresh pdbg state.
+ */
+bool daemonStale = false;
+
+/**
+ * Returns true if the pdbg state kept by the daemon may no longer
+ * match the system.  That is when the device tree file was replaced
+ * or written, by a procedure or by another service, or when a CFAM
+ * reset or an FSI scan changed the FSI devices pdbg probed.
+ */
+bool isDaemonStale()
+{
+    return !(getDevtreeVersion() == daemonDevtree) ||
+           (openpower::targeting::Targeting::getGeneration() !=
+            daemonGeneration);
+}
+
+/**
+ * The sd-bus method handler for every procedure the daemon exports.
+ * The procedure to run is the D-Bus member name, and the reply is
+ * the return code the command line would have exited with.
+ *
+ * If the daemon's state went stale since the last call, the call
+ * fails with daemonRestartingError instead, and the caller runs the
+ * procedure itself while the daemon restarts.
+ */
+int callProcedure(sd_bus_message* msg, void*, sd_bus_error* error)
+{
+    const ProcedureMap& procedures = Registration::getProcedures();
+    sdbusplus::message_t message{msg};
+
+    if (daemonStale || isDaemonStale())
+    {
+        daemonStale = true;
+        return sd_bus_error_set(error, daemonRestartingError,
+                                "The daemon state is stale, restarting");
+    }
+
+    auto procedure = procedures.find(message.get_member());
+
+    int32_t rc = -1;
+    if (procedure != procedures.end())
+    {
+        log<level::INFO>("Running procedure",
+                         entry("ACTION=%s", procedure->first.c_str()));
+        rc = runProcedure(procedure->first, procedure->second);
+
+        daemonStale = isDaemonStale();
+    }
+
+    auto reply = message.new_method_return();
+    reply.append(rc);
+    reply.method_return();
+
+    return 1;
+}
+
+/**
+ * Runs as a daemon that exports every procedure as a D-Bus method,
+ * except the standalone ones that initialize pdbg themselves,
+ * so the pdbg, libekb and D-Bus state is only set up once instead of
+ * on every procedure run.  Calls are handled one at a time.
+ *
+ * pdbg can't reload its device tree or forget what it probed, so the
+ * daemon exits whenever isDaemonStale() says its state doesn't match
+ * the system any more, and relies on systemd to restart it.  This is
+ * checked after every call and before the next one, so changes made
+ * by other services in between are seen too.  Anything that check
+ * can't see, like FSI changes made outside of this daemon, isn't
+ * picked up until the next restart.
+ *
+ * @param[in] procedures - the procedures to export
+ *
+ * @return int - the exit code
+ */
+int runDaemon(const ProcedureMap& procedures)
+{
+    auto bus = sdbusplus::bus::new_default();
+
+    // The procedure names outlive the vtable, so they can be used
+    // as the member names directly.
+    std::vector<sdbusplus::vtable_t> vtable{sdbusplus::vtable::start()};
+    for (const auto& p : procedures)
+    {
+        if (Registration::isStandalone(p.first))
+        {
+            continue;
+        }
+        vtable.push_back(sdbusplus::vtable::method(p.first.c_str(), "", "i",
+                                                   callProcedure));
+    }
+    vtable.push_back(sdbusplus::vtable::end());
+
+    sdbusplus::server::interface_t interface{bus, daemonObjectPath,
+                                             daemonInterface, vtable.data(),
+                                             nullptr};
+    daemonDevtree = getDevtreeVersion();
+    daemonGeneration = openpower::targeting::Targeting::getGeneration();
+    bus.request_name(daemonBusName);
+
+    while (!daemonStale)
+    {
+        bus.process_discard();
+        if (!daemonStale)
+        {
+            bus.wait();
+        }
+    }
+
+    log<level::INFO>("Device tree or FSI devices changed, exiting so pdbg is "
+                     "reinitialized");
+
+    return 0;
+}
+
+/**
+ * Runs a procedure in the daemon, if it is running.
+ *
+ * @param[in] action - the procedure name
+ *
+ * @return std::optional<int> - the procedure return code, or
+ *                              std::nullopt if the daemon isn't running
+ *                              or is restarting
+ */
+std::optional<int> runInDaemon(const std::string& action)
+{
+    auto isNotRunning = [](const sdbusplus::exception_t& e) {
+        return (strcmp(e.name(), "org.freedesktop.DBus.Error.ServiceUnknown") ==
+                0) ||
+               (strcmp(e.name(), "org.freedesktop.DBus.Error.NameHasNoOwner") ==
+                0) ||
+               (strcmp(e.name(), daemonRestartingError) == 0);
+    };
+
+    try
+    {
+        auto bus = sdbusplus::bus::new_default();
+        auto method = bus.new_method_call(daemonBusName, daemonObjectPath,
+                                          daemonInterface, action.c_str());
+
+        try
+        {
+            // Procedures like startHost can run for minutes, so wait for
+            // the reply however long it takes.
+            auto reply =
+                bus.call(method, std::numeric_limits<uint64_t>::max());
+
+            int32_t rc = 0;
+            reply.read(rc);
+            return rc;
+        }
+        catch (const sdbusplus::exception_t& e)
+        {
+            if (isNotRunning(e))
+            {
+                return std::nullopt;
+            }
+
+            // The procedure may have already run, so don't run it again
+            log<level::ERR>("Failed calling the procedure in the daemon",
+                            entry("ACTION=%s", action.c_str()),
+                            entry("ERROR=%s", e.what()));
+            return -1;
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        // Without D-Bus there is no daemon to call
+        return std::nullopt;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const ProcedureMap& procedures = Registration::getProcedures();
+
+    if (argc != 2)
+    {
+        usage(argv, procedures);
+        return -1;
+    }
+
+    std::string action{argv[1]};
+
+    if (action == "--daemon")
+    {
+        return runDaemon(procedures);
+    }
+
+    auto procedure = procedures.find(action);
+
+    if (procedure == procedures.end())
+    {
+        usage(argv, procedures);
+        return -1;
+    }
+
+    if (!Registration::isStandalone(action))
+    {
+        if (auto rc = runInDaemon(action))
+        {
+            return *rc;
+        }
+    }
+
+    return runProcedure(procedure->first, procedure->second);
+}
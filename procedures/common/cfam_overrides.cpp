@@ -48,19 +48,31 @@ void CFAMOverride()
                 line.erase(0, line.find_first_not_of(" \t\r\n"));
                 if (!line.empty() && line.at(0) != '#')
                 {
+                    namespace error =
+                        sdbusplus::xyz::openbmc_project::Common::Error;
+                    namespace metadata =
+                        phosphor::logging::xyz::openbmc_project::Common;
+
                     mask = 0xFFFFFFFF;
                     if (sscanf(line.c_str(), "%zu %hx %x %x", &pos, &address,
                                &data, &mask) >= 3)
                     {
-                        const auto& target = targets.getTarget(pos);
-                        writeRegWithMask(target, address, data, mask);
+                        try
+                        {
+                            auto& target = targets.getTarget(pos);
+                            writeRegWithMask(target, address, data, mask);
+                        }
+                        catch (const TargetNotFound& e)
+                        {
+                            phosphor::logging::elog<error::InvalidArgument>(
+                                metadata::InvalidArgument::ARGUMENT_NAME(
+                                    "position"),
+                                metadata::InvalidArgument::ARGUMENT_VALUE(
+                                    line.c_str()));
+                        }
                     }
                     else
                     {
-                        namespace error =
-                            sdbusplus::xyz::openbmc_project::Common::Error;
-                        namespace metadata =
-                            phosphor::logging::xyz::openbmc_project::Common;
                         phosphor::logging::elog<error::InvalidArgument>(
                             metadata::InvalidArgument::ARGUMENT_NAME("line"),
                             metadata::InvalidArgument::ARGUMENT_VALUE(
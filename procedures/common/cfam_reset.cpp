@@ -3,6 +3,7 @@
 #include <gpiod.hpp>
 #include <phosphor-logging/log.hpp>
 #include <registration.hpp>
+#include <targeting.hpp>
 
 #include <chrono>
 #include <fstream>
@@ -24,6 +25,9 @@ using namespace phosphor::logging;
  */
 void cfamReset()
 {
+    // The FSI slaves go away across the reset
+    openpower::targeting::Targeting::invalidate();
+
     // First look if system supports kernel sysfs based cfam reset
     // If it does then write a 1 and let the kernel handle the reset
     std::ofstream file;
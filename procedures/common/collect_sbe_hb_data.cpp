@@ -96,27 +96,34 @@ void collectSBEHBData()
 
     Targeting targets;
 
-    for (const auto& proc : targets)
-    {
-        // Read and parse SBE messaging register
-        try
-        {
+    // Read and parse the SBE messaging register of every processor.
+    // A failure on one doesn't stop the others, so as much info as
+    // possible is captured.
+    auto result = targets.forEachParallel(
+        [](auto& proc) {
             auto readData = readReg(proc, P9_SBE_MSG_REGISTER);
             auto msg = reinterpret_cast<const sbeMsgReg_t*>(&readData);
             log<level::INFO>("SBE status register",
-                             entry("PROC=%d", proc->getPos()),
+                             entry("PROC=%d", proc.getPos()),
                              entry("SBE_MAJOR_ISTEP=%d", msg->PACK.majorStep),
                              entry("SBE_MINOR_ISTEP=%d", msg->PACK.minorStep),
                              entry("REG_VAL=0x%08X", msg->data32));
+        },
+        MasterOrder::concurrent);
+
+    for (const auto& [pos, error] : result.errors)
+    {
+        try
+        {
+            std::rethrow_exception(error);
         }
         catch (const std::exception& e)
         {
-            log<level::ERR>(e.what());
-            // We want to continue - capturing as much info as possible
+            log<level::ERR>(e.what(), entry("PROC=%d", pos));
         }
     }
 
-    const auto& master = *(targets.begin());
+    auto& master = *(targets.begin());
     // Read and parse HB messaging register
     try
     {
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "registration.hpp"
+#include "targeting.hpp"
 
 #include <org/open_power/Proc/FSI/error.hpp>
 #include <phosphor-logging/elog-errors.hpp>
@@ -119,6 +120,9 @@ void scan()
         elog<fsi_error::SlaveDetectionFailure>(
             metadata::ERRNO(e.code().value()));
     }
+
+    // The scan may have changed which slaves are present
+    openpower::targeting::Targeting::invalidate();
 }
 
 REGISTER_PROCEDURE("scanFSI", scan)
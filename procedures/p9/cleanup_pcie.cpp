@@ -44,20 +44,14 @@ void cleanupPcie()
 
         log<level::INFO>("Running P9 procedure cleanupPcie");
 
-        // Disable the PCIE drivers and receiver on all CPUs
-        for (const auto& target : targets)
-        {
-            try
-            {
+        // Disable the PCIE drivers and receiver on all CPUs.  Failures
+        // are ignored, as an error log isn't needed coming from the power
+        // off path, and the other processors are still done.
+        targets.forEachParallel(
+            [](auto& target) {
                 writeReg(target, P9_ROOT_CTRL1_CLEAR, 0x00001C00);
-            }
-            catch (const std::exception& e)
-            {
-                // Don't need an error log coming from the power off
-                // path, just keep trying on the other processors.
-                continue;
-            }
-        }
+            },
+            MasterOrder::concurrent);
     }
     catch (const file_error::Open& e)
     {
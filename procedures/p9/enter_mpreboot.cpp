@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include "config.h"
+
+#include "parallel.hpp"
 #include "registration.hpp"
 
 extern "C"
@@ -22,13 +25,11 @@ extern "C"
 #include <libpdbg_sbe.h>
 }
 
-#include <sys/wait.h>
-#include <unistd.h>
-
 #include <phosphor-logging/log.hpp>
 
+#include <chrono>
 #include <format>
-#include <system_error>
+#include <stdexcept>
 #include <vector>
 
 namespace openpower
@@ -36,25 +37,42 @@ namespace openpower
 namespace misc
 {
 
+/**
+ * @brief The longest time to wait for all of the SBEs to enter MPIPL
+ */
+constexpr auto mpRebootTimeout = std::chrono::minutes(2);
+
+/**
+ * @brief The outcome of entering MPIPL on one processor
+ */
+struct MpRebootResult
+{
+    /** The pib target index */
+    uint32_t index = 0;
+
+    /** The sbe_mpipl_enter return code, negative on failure */
+    int rc = 0;
+
+    /** How long sbe_mpipl_enter took */
+    std::chrono::milliseconds duration{};
+};
+
 /**
  * @brief Calls sbe_enter_mpipl on the SBE in the provided target.
- * @return void
+ * @return the outcome
  */
-void sbeEnterMpReboot(struct pdbg_target* tgt)
+MpRebootResult sbeEnterMpReboot(struct pdbg_target* tgt)
 {
-    using namespace phosphor::logging;
-    int error = 0;
-    if ((error = sbe_mpipl_enter(tgt)) < 0)
-    {
-        log<level::ERR>("Failed to initiate memory preserving reboot");
-        // TODO Create a PEL in the future for this failure case.
-        throw std::system_error(error, std::generic_category(),
-                                "Failed to initiate memory preserving reboot");
-    }
+    using namespace std::chrono;
 
-    log<level::INFO>(
-        std::format("Enter MPIPL completed on proc({})", pdbg_target_index(tgt))
-            .c_str());
+    MpRebootResult result;
+    result.index = pdbg_target_index(tgt);
+
+    auto start = steady_clock::now();
+    result.rc = sbe_mpipl_enter(tgt);
+    result.duration = duration_cast<milliseconds>(steady_clock::now() - start);
+
+    return result;
 }
 
 /**
@@ -65,7 +83,7 @@ void enterMpReboot()
 {
     using namespace phosphor::logging;
     struct pdbg_target* target;
-    std::vector<pid_t> pidList;
+    std::vector<struct pdbg_target*> targets;
     bool failed = false;
     pdbg_targets_init(NULL);
 
@@ -76,43 +94,45 @@ void enterMpReboot()
         {
             continue;
         }
-
-        pid_t pid = fork();
-
-        if (pid < 0)
-        {
-            log<level::ERR>("Fork failed while starting mp reboot");
-            failed = true;
-        }
-        else if (pid == 0)
-        {
-            sbeEnterMpReboot(target);
-            std::exit(EXIT_SUCCESS);
-        }
-        else
-        {
-            pidList.push_back(std::move(pid));
-        }
+        targets.push_back(target);
     }
 
-    for (auto& p : pidList)
+    // The SBEs are started MAX_CHILD_PROCS at a time, each from its own
+    // process as libpdbg isn't thread safe.
+    auto results = util::runInChildren(
+        targets.size(), [&](size_t i) { return sbeEnterMpReboot(targets[i]); },
+        MAX_CHILD_PROCS, mpRebootTimeout);
+
+    for (size_t i = 0; i < results.size(); i++)
     {
-        int status = 0;
-        waitpid(p, &status, 0);
-        if (WEXITSTATUS(status))
+        const auto& result = results[i];
+
+        if (!result || (result->rc < 0))
         {
-            log<level::ERR>("Memory preserving reboot failed");
+            // TODO Create a PEL in the future for this failure case.
+            log<level::ERR>(
+                std::format("Failed to initiate memory preserving reboot on "
+                            "proc({}), rc({})",
+                            pdbg_target_index(targets[i]),
+                            result ? result->rc : -1)
+                    .c_str());
             failed = true;
+            continue;
         }
+
+        log<level::INFO>(std::format("Enter MPIPL completed on proc({}) in "
+                                     "{}ms",
+                                     result->index, result->duration.count())
+                             .c_str());
     }
 
     if (failed)
     {
-        std::exit(EXIT_FAILURE);
+        throw std::runtime_error("Memory preserving reboot failed");
     }
 }
 
-REGISTER_PROCEDURE("enterMpReboot", enterMpReboot)
+REGISTER_STANDALONE_PROCEDURE("enterMpReboot", enterMpReboot)
 
 } // namespace misc
 } // namespace openpower
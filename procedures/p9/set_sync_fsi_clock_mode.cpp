@@ -33,7 +33,7 @@ using namespace openpower::targeting;
 void setSynchronousFSIClock()
 {
     Targeting targets;
-    const auto& master = *(targets.begin());
+    auto& master = *(targets.begin());
 
     // Set bit 31 to 0
     writeRegWithMask(master, P9_LL_MODE_REG, 0x00000000, 0x00000001);
@@ -38,7 +38,7 @@ using namespace openpower::targeting;
 void startHost()
 {
     Targeting targets;
-    const auto& master = *(targets.begin());
+    auto& master = *(targets.begin());
 
     log<level::INFO>("Running P9 procedure startHost",
                      entry("NUM_PROCS=%d", targets.size()));
@@ -47,23 +47,28 @@ void startHost()
     writeReg(master, P9_LL_MODE_REG, 0x00000001);
 
     // Clock mux select override
-    for (const auto& t : targets)
-    {
-        writeRegWithMask(t, P9_ROOT_CTRL8, 0x0000000C, 0x0000000C);
-    }
-
-    // Enable P9 checkstop to be reported to the BMC
+    targets
+        .forEachParallel(
+            [](auto& t) {
+                writeRegWithMask(t, P9_ROOT_CTRL8, 0x0000000C, 0x0000000C);
+            },
+            MasterOrder::concurrent)
+        .rethrowFirst();
+
+    // Enable P9 checkstop to be reported to the BMC, before anything
+    // that can fail, like the boot count lookup below.
+    Transaction checkstop{master};
 
     // Setup FSI2PIB to report checkstop
-    writeReg(master, P9_FSI_A_SI1S, 0x20000000);
+    checkstop.write(P9_FSI_A_SI1S, 0x20000000);
 
     // Enable Xstop/ATTN interrupt
-    writeReg(master, P9_FSI2PIB_TRUE_MASK, 0x60000000);
+    checkstop.write(P9_FSI2PIB_TRUE_MASK, 0x60000000);
 
     // Arm it
-    writeReg(master, P9_FSI2PIB_INTERRUPT, 0xFFFFFFFF);
+    checkstop.write(P9_FSI2PIB_INTERRUPT, 0xFFFFFFFF);
 
-    // Kick off the SBE to start the boot
+    checkstop.submit();
 
     // Choose seeprom side to boot from
     cfam_data_t sbeSide = 0;
@@ -79,15 +84,28 @@ void startHost()
         log<level::INFO>("Setting SBE seeprom side to 1",
                          entry("SBE_SIDE_SELECT=%d", 1));
     }
+
+    // The SBE start sequence below updates P9_CBS_CS twice in a row, so
+    // let the second masked write use the value written by the first.
+    master.setShadowing(true);
+
+    Transaction transaction{master};
+
+    // Kick off the SBE to start the boot
+
     // Bit 17 of the ctrl status reg indicates sbe seeprom boot side
     // 0 -> Side 0, 1 -> Side 1
-    writeRegWithMask(master, P9_SBE_CTRL_STATUS, sbeSide, 0x00004000);
+    transaction.writeWithMask(P9_SBE_CTRL_STATUS, sbeSide, 0x00004000);
 
     // Ensure SBE start bit is 0 to handle warm reboot scenarios
-    writeRegWithMask(master, P9_CBS_CS, 0x00000000, 0x80000000);
+    transaction.writeWithMask(P9_CBS_CS, 0x00000000, 0x80000000);
 
     // Start the SBE
-    writeRegWithMask(master, P9_CBS_CS, 0x80000000, 0x80000000);
+    transaction.writeWithMask(P9_CBS_CS, 0x80000000, 0x80000000);
+
+    transaction.submit();
+
+    master.setShadowing(false);
 }
 
 REGISTER_PROCEDURE("startHost", startHost)
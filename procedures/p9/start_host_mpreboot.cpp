@@ -44,7 +44,7 @@ void startHostMpReboot()
     using namespace phosphor::logging;
 
     Targeting targets;
-    const auto& master = *(targets.begin());
+    auto& master = *(targets.begin());
 
     log<level::INFO>("Running P9 procedure startHostMpReboot",
                      entry("NUM_PROCS=%d", targets.size()));
@@ -53,21 +53,25 @@ void startHostMpReboot()
     writeReg(master, P9_LL_MODE_REG, 0x00000001);
 
     // Clock mux select override
-    for (const auto& t : targets)
+    for (auto& t : targets)
     {
         writeRegWithMask(t, P9_ROOT_CTRL8, 0x0000000C, 0x0000000C);
     }
 
-    // Enable P9 checkstop to be reported to the BMC
+    // Enable P9 checkstop to be reported to the BMC, before anything
+    // that can fail, like the boot count lookup below.
+    Transaction checkstop{master};
 
     // Setup FSI2PIB to report checkstop
-    writeReg(master, P9_FSI_A_SI1S, 0x20000000);
+    checkstop.write(P9_FSI_A_SI1S, 0x20000000);
 
     // Enable Xstop/ATTN interrupt
-    writeReg(master, P9_FSI2PIB_TRUE_MASK, 0x60000000);
+    checkstop.write(P9_FSI2PIB_TRUE_MASK, 0x60000000);
 
     // Arm it
-    writeReg(master, P9_FSI2PIB_INTERRUPT, 0xFFFFFFFF);
+    checkstop.write(P9_FSI2PIB_INTERRUPT, 0xFFFFFFFF);
+
+    checkstop.submit();
 
     // Kick off the SBE to start the boot
 
@@ -110,7 +114,7 @@ void startHostMpReboot()
     }
 }
 
-REGISTER_PROCEDURE("startHostMpReboot", startHostMpReboot)
+REGISTER_STANDALONE_PROCEDURE("startHostMpReboot", startHostMpReboot)
 
 } // namespace p9
 } // namespace openpower
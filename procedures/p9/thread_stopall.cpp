@@ -45,7 +45,7 @@ void threadStopAll(void)
     log<level::INFO>("Processor thread stopall completed");
 }
 
-REGISTER_PROCEDURE("threadStopAll", threadStopAll)
+REGISTER_STANDALONE_PROCEDURE("threadStopAll", threadStopAll)
 
 } // namespace phal
 } // namespace openpower
@@ -6,8 +6,10 @@ extern "C"
 #include "extensions/phal/common_utils.hpp"
 #include "extensions/phal/create_pel.hpp"
 #include "extensions/phal/pdbg_utils.hpp"
+#include "extensions/phal/proc_inventory.hpp"
 #include "p10_cfam.hpp"
 #include "registration.hpp"
+#include "util.hpp"
 
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
@@ -27,7 +29,7 @@ using namespace phosphor::logging;
 /** Best effort function to create a BMC dump */
 void createBmcDump()
 {
-    auto bus = sdbusplus::bus::new_default();
+    auto& bus = util::getBus();
 
     auto method = bus.new_method_call(
         "xyz.openbmc_project.Dump.Manager", "/xyz/openbmc_project/dump/bmc",
@@ -61,8 +63,6 @@ void createBmcDump()
  */
 void checkHostRunning()
 {
-    struct pdbg_target* procTarget;
-
     try
     {
         phal_init();
@@ -76,13 +76,10 @@ void checkHostRunning()
         throw std::runtime_error("PHAL initialization failed");
     }
 
-    pdbg_for_each_class_target("proc", procTarget)
+    // Only check the primary proc
+    if (auto primary = ProcInventory::get().getPrimary())
     {
-        // Only check the primary proc
-        if (!isPrimaryProc(procTarget))
-        {
-            continue;
-        }
+        struct pdbg_target* procTarget = primary->target;
 
         uint32_t val = 0;
         constexpr uint32_t HOST_RUNNING_INDICATION = 0xA5000001;
@@ -141,7 +138,6 @@ void checkHostRunning()
  */
 void clearHostRunning()
 {
-    struct pdbg_target* procTarget;
     log<level::INFO>("Entering clearHostRunning");
 
     try
@@ -157,16 +153,11 @@ void clearHostRunning()
         throw std::runtime_error("PHAL initialization failed");
     }
 
-    pdbg_for_each_class_target("proc", procTarget)
+    // Only clear the primary proc
+    if (auto primary = ProcInventory::get().getPrimary())
     {
-        // Only check the primary proc
-        if (!isPrimaryProc(procTarget))
-        {
-            continue;
-        }
-
         constexpr uint32_t HOST_NOT_RUNNING_INDICATION = 0;
-        auto rc = putCFAM(procTarget, P10_SCRATCH_REG_12,
+        auto rc = putCFAM(primary->target, P10_SCRATCH_REG_12,
                           HOST_NOT_RUNNING_INDICATION);
         if (rc != 0)
         {
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include "config.h"
+
 #include "registration.hpp"
 
 extern "C"
@@ -24,17 +26,19 @@ extern "C"
 
 #include "extensions/phal/create_pel.hpp"
 #include "extensions/phal/dump_utils.hpp"
+#include "extensions/phal/proc_inventory.hpp"
+#include "parallel.hpp"
 
 #include <attributes_info.H>
 #include <libphal.H>
 #include <phal_exception.H>
-#include <sys/wait.h>
-#include <unistd.h>
 
 #include <phosphor-logging/log.hpp>
 
+#include <chrono>
 #include <format>
-#include <system_error>
+#include <optional>
+#include <stdexcept>
 #include <vector>
 
 namespace openpower
@@ -42,17 +46,51 @@ namespace openpower
 namespace misc
 {
 
+/**
+ * @brief The longest time to wait for all of the SBEs to enter MPIPL
+ */
+constexpr auto mpRebootTimeout = std::chrono::minutes(2);
+
+/**
+ * @brief The outcome of entering MPIPL on one processor
+ */
+struct MpRebootResult
+{
+    /** The processor index */
+    uint32_t index = 0;
+
+    /** If entering MPIPL failed */
+    bool failed = false;
+
+    /** The SBE error type of a failure, 0 if it was not an SBE error */
+    int errType = 0;
+
+    /** The id of the PEL created for a failure, 0 if there isn't one */
+    uint32_t logId = 0;
+
+    /** The SBE dump to collect for a failure, if one is needed */
+    std::optional<openpower::phal::dump::DumpParameters> dump;
+
+    /** How long it took, including the error handling */
+    std::chrono::milliseconds duration{};
+};
+
 /**
  * @brief Calls sbe_enter_mpipl on the SBE in the provided target.
- * @return void
+ * @return the outcome, the dump is left for the caller to request
  */
-void sbeEnterMpReboot(struct pdbg_target* tgt)
+MpRebootResult sbeEnterMpReboot(struct pdbg_target* tgt)
 {
     using namespace openpower::pel;
     using namespace openpower::phal;
     using namespace openpower::phal::sbe;
     using namespace openpower::phal::exception;
     using namespace phosphor::logging;
+    using namespace std::chrono;
+
+    MpRebootResult result;
+    result.index = pdbg_target_index(tgt);
+    auto start = steady_clock::now();
 
     try
     {
@@ -66,13 +104,15 @@ void sbeEnterMpReboot(struct pdbg_target* tgt)
             // Skip the request, no additional error handling required.
             log<level::INFO>(
                 std::format("EnterMPIPL: Skipping ({}) on proc({})",
-                            sbeError.what(), pdbg_target_index(tgt))
+                            sbeError.what(), result.index)
                     .c_str());
-            return;
+            result.duration =
+                duration_cast<milliseconds>(steady_clock::now() - start);
+            return result;
         }
 
         log<level::ERR>(std::format("EnterMPIPL failed({}) on proc({})",
-                                    sbeError.what(), pdbg_target_index(tgt))
+                                    sbeError.what(), result.index)
                             .c_str());
 
         std::string event;
@@ -89,7 +129,7 @@ void sbeEnterMpReboot(struct pdbg_target* tgt)
         }
 
         // SRC6 : [0:15] chip position [16:23] command class, [24:31] Type
-        uint32_t index = pdbg_target_index(tgt);
+        uint32_t index = result.index;
 
         // TODO Replace these consts with pdbg defines once it is exported.
         // Ref : pdbg/libsbefifo/sbefifo_private.h
@@ -101,33 +141,42 @@ void sbeEnterMpReboot(struct pdbg_target* tgt)
         FFDCData pelAdditionalData;
         pelAdditionalData.emplace_back("SRC6",
                                        std::to_string((index << 16) | cmd));
-        auto logId = createSbeErrorPEL(event, sbeError, pelAdditionalData, tgt);
+
+        result.failed = true;
+        result.errType = static_cast<int>(sbeError.errType());
+        result.logId =
+            createSbeErrorPEL(event, sbeError, pelAdditionalData, tgt);
 
         if (dumpIsRequired)
         {
-            // Request SBE Dump
             using namespace openpower::phal::dump;
-            DumpParameters dumpParameters = {logId, index, SBE_DUMP_TIMEOUT,
-                                             DumpType::SBE};
-            requestDump(dumpParameters);
+            result.dump = DumpParameters{result.logId, index,
+                                         SBE_DUMP_TIMEOUT, DumpType::SBE};
         }
-        throw;
     }
     // Capture genaral libphal error
     catch (const phalError_t& phalError)
     {
         // Failure reported
         log<level::ERR>(std::format("captureFFDC: Exception({}) on proc({})",
-                                    phalError.what(), pdbg_target_index(tgt))
+                                    phalError.what(), result.index)
                             .c_str());
         openpower::pel::createPEL(
             "org.open_power.Processor.Error.SbeChipOpFailure");
-        throw;
+        result.failed = true;
+    }
+
+    result.duration = duration_cast<milliseconds>(steady_clock::now() - start);
+
+    if (!result.failed)
+    {
+        log<level::INFO>(std::format("Enter MPIPL completed on proc({}) in "
+                                     "{}ms",
+                                     result.index, result.duration.count())
+                             .c_str());
     }
 
-    log<level::INFO>(
-        std::format("Enter MPIPL completed on proc({})", pdbg_target_index(tgt))
-            .c_str());
+    return result;
 }
 
 /**
@@ -137,68 +186,79 @@ void sbeEnterMpReboot(struct pdbg_target* tgt)
 void enterMpReboot()
 {
     using namespace phosphor::logging;
-    struct pdbg_target* target;
-    std::vector<pid_t> pidList;
+    using namespace openpower::phal::dump;
+    std::vector<struct pdbg_target*> targets;
     bool failed = false;
     pdbg_targets_init(NULL);
-    ATTR_HWAS_STATE_Type hwasState;
 
     log<level::INFO>("Starting memory preserving reboot");
-    pdbg_for_each_class_target("proc", target)
+    for (const auto& proc : openpower::phal::ProcInventory::get().functional())
     {
-        if (DT_GET_PROP(ATTR_HWAS_STATE, target, hwasState))
-        {
-            log<level::ERR>("Could not read HWAS_STATE attribute");
-        }
-        if (!hwasState.functional)
-        {
-            continue;
-        }
+        // Probe here so each child below doesn't probe them again
+        pdbg_target_probe(proc.target);
+        targets.push_back(proc.target);
+    }
+
+    // if no functional proc found exit with failure
+    if (targets.empty())
+    {
+        log<level::ERR>("EnterMPReboot is not executed on any processors");
+        openpower::pel::createPEL("org.open_power.PHAL.Error.MPReboot");
+        throw std::runtime_error("No functional processors for MPReboot");
+    }
 
-        pid_t pid = fork();
+    // The SBEs are started MAX_CHILD_PROCS at a time, each from its own
+    // process as libpdbg and libphal aren't thread safe.  A failing child
+    // creates its own PEL, with its own copy of the PHAL traces.
+    auto results = util::runInChildren(
+        targets.size(), [&](size_t i) { return sbeEnterMpReboot(targets[i]); },
+        MAX_CHILD_PROCS, mpRebootTimeout);
 
-        if (pid < 0)
+    std::vector<DumpParameters> dumps;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& result = results[i];
+
+        if (!result)
         {
-            log<level::ERR>("Fork failed while starting mp reboot");
+            log<level::ERR>(
+                std::format("EnterMPIPL: no result from proc({})",
+                            pdbg_target_index(targets[i]))
+                    .c_str());
             failed = true;
+            continue;
         }
-        else if (pid == 0)
+
+        if (result->failed)
         {
-            sbeEnterMpReboot(target);
-            std::exit(EXIT_SUCCESS);
+            failed = true;
         }
-        else
+        if (result->dump)
         {
-            pidList.push_back(std::move(pid));
+            dumps.push_back(*result->dump);
         }
     }
 
-    // if no functional proc found exit with failure
-    if (pidList.size() == 0)
-    {
-        log<level::ERR>("EnterMPReboot is not executed on any processors");
-        openpower::pel::createPEL("org.open_power.PHAL.Error.MPReboot");
-        std::exit(EXIT_FAILURE);
-    }
-
-    for (auto& p : pidList)
+    // Collect the SBE dumps of all the failed processors together
+    for (const auto& dump : requestDumps(dumps))
     {
-        int status = 0;
-        waitpid(p, &status, 0);
-        if (WEXITSTATUS(status))
+        if (dump.status != DumpStatus::Completed)
         {
-            log<level::ERR>("Memory preserving reboot failed");
-            failed = true;
+            log<level::ERR>(
+                std::format("SBE dump for PEL({}) on proc({}) not collected",
+                            dump.parameters.logId, dump.parameters.unitId)
+                    .c_str());
         }
     }
 
     if (failed)
     {
-        std::exit(EXIT_FAILURE);
+        log<level::ERR>("Memory preserving reboot failed");
+        throw std::runtime_error("Memory preserving reboot failed");
     }
 }
 
-REGISTER_PROCEDURE("enterMpReboot", enterMpReboot)
+REGISTER_STANDALONE_PROCEDURE("enterMpReboot", enterMpReboot)
 
 } // namespace misc
 } // namespace openpower
@@ -1,19 +1,22 @@
 #include "config.h"
 
 #include "extensions/phal/create_pel.hpp"
-#include "extensions/phal/pdbg_utils.hpp"
 #include "registration.hpp"
 
-#include <sys/wait.h>
-#include <unistd.h>
-
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/log.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <cstdio>
 #include <filesystem>
 #include <format>
+#include <memory>
+
+extern "C"
+{
+#include <dtree.h>
+}
 
 namespace openpower
 {
@@ -34,43 +37,28 @@ void importDevtree()
         return;
     }
 
-    // Update PDBG_DTB value
-    openpower::phal::setDevtreeEnv();
-
-    // Update PDATA_INFODB value
-    openpower::phal::setPdataInfoDBEnv();
-
-    int status = 0;
-    pid_t pid = fork();
-    if (pid == 0)
+    std::unique_ptr<FILE, decltype(&fclose)> fpImport(
+        fopen(DEVTREE_EXP_FILE, "r"), &fclose);
+    if (!fpImport)
     {
-        std::string cmd("/usr/bin/attributes ");
-        cmd += "import ";
-        cmd += DEVTREE_EXP_FILE;
-        cmd += " 2>";
-        cmd += " /dev/null";
-        execl("/bin/sh", "sh", "-c", cmd.c_str(), 0);
-
-        auto error = errno;
-        log<level::ERR>(std::format("Error occurred during attributes import "
-                                    "execution, errno({})",
-                                    error)
-                            .c_str());
-    }
-    else if (pid > 0)
-    {
-        waitpid(pid, &status, 0);
-        if (WEXITSTATUS(status))
-        {
-            log<level::ERR>("Failed to import attribute data");
-            openpower::pel::createPEL("org.open_power.PHAL.Error.devtreeSync");
-            return;
-        }
+        log<level::ERR>(
+            std::format("Failed to open import data file ({}) errno({})",
+                        DEVTREE_EXP_FILE, errno)
+                .c_str());
+        openpower::pel::createPEL("org.open_power.PHAL.Error.devtreeSync");
+        return;
     }
-    else
+
+    // Update the devtree in this process
+    auto ret = dtree_cronus_import(CEC_DEVTREE_RW_PATH, CEC_INFODB_PATH,
+                                   fpImport.get());
+    fpImport.reset();
+    if (ret)
     {
-        log<level::ERR>("fork() failed.");
-        throw std::runtime_error("importDevtree: fork() failed.");
+        log<level::ERR>(
+            std::format("Failed({}) to import attribute data", ret).c_str());
+        openpower::pel::createPEL("org.open_power.PHAL.Error.devtreeSync");
+        return;
     }
 
     try
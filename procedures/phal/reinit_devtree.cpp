@@ -1,6 +1,8 @@
 #include "config.h"
 
 #include "extensions/phal/create_pel.hpp"
+#include "extensions/phal/devtree_patch.hpp"
+#include "extensions/phal/fdt_file.hpp"
 #include "registration.hpp"
 #include "temporary_file.hpp"
 
@@ -12,6 +14,9 @@
 #include <cstdio>
 #include <filesystem>
 #include <format>
+#include <fstream>
+#include <optional>
+#include <string>
 
 extern "C"
 {
@@ -35,9 +40,10 @@ using FILE_Ptr = std::unique_ptr<FILE, FileCloser>;
 
 namespace fs = std::filesystem;
 
+constexpr auto DEVTREE_ATTR_OVERRIDE_PATH = "/tmp/devtree_attr_override";
+
 void applyAttrOverride(fs::path& devtreeFile)
 {
-    constexpr auto DEVTREE_ATTR_OVERRIDE_PATH = "/tmp/devtree_attr_override";
     auto overrideFile = fs::path(DEVTREE_ATTR_OVERRIDE_PATH);
     if (!fs::exists(overrideFile))
     {
@@ -94,6 +100,103 @@ fs::path computeRODeviceTreePath()
     return roFilePath;
 }
 
+std::string readFile(const fs::path& path)
+{
+    std::ifstream file{path};
+    if (!file)
+    {
+        throw std::runtime_error("Unable to read " + path.string());
+    }
+    return {std::istreambuf_iterator<char>{file}, {}};
+}
+
+std::optional<Fingerprint> loadFingerprint()
+{
+    std::ifstream file{DEVTREE_REINIT_FINGERPRINT_FILE};
+    Fingerprint fingerprint;
+    if (file >> std::hex >> fingerprint.roHash >> fingerprint.listHash >>
+        fingerprint.rwHash)
+    {
+        return fingerprint;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Save the fingerprint of the r/w devtree just built, or remove
+ *        the old one if the r/w devtree can't be rebuilt from it.
+ *        Failures are only logged, the next boot does a full reinit.
+ */
+void saveFingerprint(const fs::path& rwFilePath, bool valid)
+{
+    try
+    {
+        fs::path path{DEVTREE_REINIT_FINGERPRINT_FILE};
+        if (!valid)
+        {
+            fs::remove(path);
+            return;
+        }
+
+        FdtFile ro{computeRODeviceTreePath()};
+        FdtFile rw{rwFilePath};
+        auto fingerprint =
+            getFingerprint(ro, readFile(DEVTREE_REINIT_ATTRS_LIST), rw);
+
+        fs::create_directories(path.parent_path());
+        openpower::util::TemporaryFile tmpFile{path.parent_path()};
+        std::ofstream(tmpFile.getPath())
+            << std::format("{:016x} {:016x} {:016x}\n", fingerprint.roHash,
+                           fingerprint.listHash, fingerprint.rwHash);
+        tmpFile.moveTo(path);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>(
+            std::format("reinitDevtree: fingerprint update failed ({})",
+                        e.what())
+                .c_str());
+    }
+}
+
+/**
+ * @brief Skip the reinit, or patch only the changed attributes, when
+ *        the r/o devtree and the reinit attribute list are the ones the
+ *        r/w devtree was last built from.
+ *
+ * @return true if the r/w devtree is up to date, false if a full
+ *         reinit is needed.
+ */
+bool differentialReinit(const fs::path& rwFilePath)
+{
+    try
+    {
+        auto previous = loadFingerprint();
+        if (!previous || fs::exists(DEVTREE_ATTR_OVERRIDE_PATH))
+        {
+            return false;
+        }
+
+        FdtFile ro{computeRODeviceTreePath()};
+        if (!updateFromFingerprint(ro, readFile(DEVTREE_REINIT_ATTRS_LIST),
+                                   rwFilePath, *previous))
+        {
+            return false;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>(
+            std::format("reinitDevtree: differential reinit failed ({})",
+                        e.what())
+                .c_str());
+        return false;
+    }
+
+    saveFingerprint(rwFilePath, true);
+    return true;
+}
+
 /**
  * @brief reinitialize the devtree attributes.
  * In the regular host boot path devtree attribute need to
@@ -105,12 +208,18 @@ fs::path computeRODeviceTreePath()
  * Steps involved
  * 1. Create attribute data file from devtree r/w version based on
  *    the reinit attribute list file bmc /usr/share/pdata path.
- * 2. Create temporary devtree file by copying devtree r/o file
+ * 2. Create temporary devtree file next to the r/w file, sharing the
+ *    devtree r/o file blocks where the file system allows it.
  * 3. Override temporary copy of devtree with attribute data file
  *    from step 1.
  * 3a. Apply user provided attribute override if present in the
  *     predefined location.
- * 4. Copy  temporary copy devtree to r/w devtree version file.
+ * 4. Atomically rename temporary copy devtree over r/w devtree version file.
+ *
+ * If the r/o devtree and attribute list are the ones the r/w devtree was
+ * last built from, the steps above are skipped when none of the attributes
+ * that aren't preserved have changed, and otherwise only those attributes
+ * are patched back to their r/o values.
  */
 
 void reinitDevtree()
@@ -121,11 +230,17 @@ void reinitDevtree()
 
     log<level::INFO>("reinitDevtree: started");
 
-    // All the file operations is done on temporary copy
-    // This is to avoid any file corruption issue during
-    // copy or attribute import path.
-    openpower::util::TemporaryFile tmpDevtreeFile{};
-    const auto copyOptions = std::filesystem::copy_options::overwrite_existing;
+    // All the file operations is done on temporary copy in the same
+    // directory as the r/w file (the symbolic link target), so it can
+    // replace the r/w file with a rename, without any copy and without
+    // ever leaving a partially written r/w file.
+    fs::path rwFilePath = fs::weakly_canonical(CEC_DEVTREE_RW_PATH);
+    if (differentialReinit(rwFilePath))
+    {
+        return;
+    }
+
+    openpower::util::TemporaryFile tmpDevtreeFile{rwFilePath.parent_path()};
     auto tmpDevtreePath = tmpDevtreeFile.getPath();
     bool tmpReinitDone = false;
     // To store callouts details in json format as per pel expectation.
@@ -179,9 +294,9 @@ void reinitDevtree()
             }
         }
 
-        // Step 2: Create temporary devtree file by copying devtree r/o version
+        // Step 2: Create temporary devtree file from devtree r/o version
         fs::path roFilePath = computeRODeviceTreePath();
-        std::filesystem::copy(roFilePath, tmpDevtreePath, copyOptions);
+        tmpDevtreeFile.copyFrom(roFilePath);
 
         // get r/o version data file pointer
         FILE_Ptr fpImport(fopen(tmpFile.getPath().c_str(), "r"), FileCloser());
@@ -234,11 +349,15 @@ void reinitDevtree()
     {
         if (tmpReinitDone)
         {
-            // Step 4: Copy temporary version devtree file r/w version file.
-            // Any copy failures should results service failure.
-            std::filesystem::copy(tmpDevtreePath, CEC_DEVTREE_RW_PATH,
-                                  copyOptions);
+            // Step 4: Rename temporary version devtree file over r/w version
+            // file. Any failures should results service failure.
+            tmpDevtreeFile.moveTo(rwFilePath);
             log<level::INFO>("reinitDevtree: completed successfully");
+
+            // Override data isn't kept on the next boot, so a devtree with
+            // it applied must be rebuilt.
+            saveFingerprint(rwFilePath,
+                            !fs::exists(DEVTREE_ATTR_OVERRIDE_PATH));
         }
         else
         {
@@ -246,7 +365,9 @@ void reinitDevtree()
             fs::path roFilePath = computeRODeviceTreePath();
             log<level::WARNING>("reinitDevtree: DEVTREE(r/w) initializing with "
                                 "genesis mode attribute data");
-            std::filesystem::copy(roFilePath, CEC_DEVTREE_RW_PATH, copyOptions);
+            tmpDevtreeFile.copyFrom(roFilePath);
+            tmpDevtreeFile.moveTo(rwFilePath);
+            saveFingerprint(rwFilePath, false);
         }
     }
     catch (const std::exception& e)
@@ -36,10 +36,13 @@ void setSPIMux()
 {
     Targeting targets;
 
-    for (const auto& t : targets)
-    {
-        writeRegWithMask(t, P10_ROOT_CTRL8, 0xF0000000, 0xF0000000);
-    }
+    targets
+        .forEachParallel(
+            [](auto& t) {
+                writeRegWithMask(t, P10_ROOT_CTRL8, 0xF0000000, 0xF0000000);
+            },
+            MasterOrder::concurrent)
+        .rethrowFirst();
 }
 
 REGISTER_PROCEDURE("setSPIMux", setSPIMux)
@@ -8,6 +8,8 @@ extern "C"
 #include "extensions/phal/common_utils.hpp"
 #include "extensions/phal/create_pel.hpp"
 #include "extensions/phal/phal_error.hpp"
+#include "extensions/phal/proc_inventory.hpp"
+#include "timing.hpp"
 #include "util.hpp"
 
 #include <libekb.H>
@@ -35,16 +37,12 @@ using namespace phosphor::logging;
  */
 void selectBootSeeprom()
 {
-    struct pdbg_target* procTarget;
     ATTR_BACKUP_SEEPROM_SELECT_Enum bkpSeePromSelect;
     ATTR_BACKUP_MEASUREMENT_SEEPROM_SELECT_Enum bkpMeaSeePromSelect;
 
-    pdbg_for_each_class_target("proc", procTarget)
+    if (auto primary = ProcInventory::get().getPrimary())
     {
-        if (!isPrimaryProc(procTarget))
-        {
-            continue;
-        }
+        struct pdbg_target* procTarget = primary->target;
 
         // Choose seeprom side to boot from based on boot count
         if (getBootCount() > 0)
@@ -103,9 +101,9 @@ void setClkNETerminationSite()
     constexpr auto kwdVpdInf = "com.ibm.ipzvpd.VINI";
     constexpr auto hwKwd = "HW";
 
-    auto bus = sdbusplus::bus::new_default();
+    auto& bus = util::getBus();
 
-    std::string service = util::getService(bus, objPath, kwdVpdInf);
+    std::string service = util::getService(objPath, kwdVpdInf);
 
     auto properties = bus.new_method_call(
         service.c_str(), objPath, "org.freedesktop.DBus.Properties", "Get");
@@ -116,6 +114,7 @@ void setClkNETerminationSite()
     std::variant<std::vector<uint8_t>> val;
     try
     {
+        util::timing::Span span{"D-Bus Get HW"};
         auto result = bus.call(properties);
         result.read(val);
     }
@@ -230,16 +229,17 @@ static bool allowHwIsolation()
 
     try
     {
-        auto bus = sdbusplus::bus::new_default();
+        auto& bus = util::getBus();
 
-        std::string service = util::getService(bus, hwIsolationPolicyObjPath,
-                                               hwIsolationPolicyIface);
+        std::string service =
+            util::getService(hwIsolationPolicyObjPath, hwIsolationPolicyIface);
 
         auto method =
             bus.new_method_call(service.c_str(), hwIsolationPolicyObjPath,
                                 "org.freedesktop.DBus.Properties", "Get");
         method.append(hwIsolationPolicyIface, "Enabled");
 
+        util::timing::Span span{"D-Bus Get Enabled"};
         auto reply = bus.call(method);
 
         auto resp = reply.unpack<std::variant<bool>>();
@@ -319,6 +319,7 @@ void startHost(enum ipl_type iplType = IPL_TYPE_NORMAL)
     openpower::pel::detail::processBootError(true);
 
     // callback method will be called upon failure which will create the PEL
+    util::timing::Span span{"ipl_run_major"};
     int rc = ipl_run_major(0);
     if (rc > 0)
     {
@@ -1,5 +1,9 @@
+#include "config.h"
+
 #include "extensions/phal/create_pel.hpp"
 #include "extensions/phal/dump_utils.hpp"
+#include "extensions/phal/proc_inventory.hpp"
+#include "parallel.hpp"
 #include "registration.hpp"
 
 #include <attributes_info.H>
@@ -7,7 +11,13 @@
 #include <libphal.H>
 #include <phal_exception.H>
 
+#include <unistd.h>
+
+#include <chrono>
 #include <format>
+#include <optional>
+#include <utility>
+#include <vector>
 extern "C"
 {
 #include <libpdbg.h>
@@ -22,6 +32,208 @@ using namespace openpower::pel;
 using namespace openpower::phal::exception;
 using namespace phosphor::logging;
 
+/**
+ * @brief The longest time to wait for all of the processors to stop
+ */
+constexpr auto threadStopAllTimeout = std::chrono::seconds(30);
+
+/**
+ * @brief The outcome of stopping the threads on one processor, passed
+ *        back from the child process that stopped them
+ */
+struct StopResult
+{
+    enum class Status
+    {
+        Stopped,
+        Skipped,
+        Failed
+    };
+
+    /** The processor index */
+    uint32_t index = 0;
+
+    /** What happened */
+    Status status = Status::Failed;
+
+    /** The SBE error type, if the stop failed */
+    int errType = 0;
+
+    /** How long the stop took */
+    std::chrono::milliseconds duration{};
+};
+
+/** A StopResult and the SBE FFDC of a failure */
+using StopOutcome = std::pair<StopResult, std::vector<uint8_t>>;
+
+/**
+ * @brief Reads the SBE FFDC that libphal collected for a failure
+ *
+ * @param[in] sbeError - the failure
+ * @return the FFDC, empty if there isn't any
+ */
+static std::vector<uint8_t> readSbeFFDC(const sbeError_t& sbeError)
+{
+    std::vector<uint8_t> ffdc;
+    auto fd = sbeError.getFd();
+
+    // Negative fd value indicates error case or invalid file
+    if ((fd <= 0) || (lseek(fd, 0, SEEK_SET) == -1))
+    {
+        return ffdc;
+    }
+
+    uint8_t buffer[4096];
+    ssize_t size = 0;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        ffdc.insert(ffdc.end(), buffer, buffer + size);
+    }
+
+    return ffdc;
+}
+
+/**
+ * @brief Stop instruction executions on all functional threads in one
+ *        processor.
+ *
+ * @param[in] procTarget - the processor
+ * @return the outcome, and the SBE FFDC if it failed
+ */
+static StopOutcome stopProcThreads(struct pdbg_target* procTarget)
+{
+    using namespace std::chrono;
+
+    StopResult result;
+    std::vector<uint8_t> ffdc;
+    result.index = pdbg_target_index(procTarget);
+    auto start = steady_clock::now();
+
+    try
+    {
+        openpower::phal::sbe::threadStopProc(procTarget);
+        result.status = StopResult::Status::Stopped;
+        log<level::INFO>(
+            std::format("Processor thread stopall completed on proc({})",
+                        result.index)
+                .c_str());
+    }
+    catch (const sbeError_t& sbeError)
+    {
+        auto errType = sbeError.errType();
+
+        // Report only valid SBE reported failures
+        if (errType == SBE_CMD_FAILED)
+        {
+            log<level::ERR>(
+                std::format(
+                    "threadStopAll failed({}) on proc({})",
+                    static_cast<std::underlying_type<ipl_error_type>::type>(
+                        errType),
+                    result.index)
+                    .c_str());
+            result.status = StopResult::Status::Failed;
+            result.errType = static_cast<int>(errType);
+            ffdc = readSbeFFDC(sbeError);
+        }
+        else
+        {
+            // SBE is not ready to accept chip-ops,
+            // Skip the request, no additional error handling required.
+            log<level::INFO>(
+                std::format("threadStopAll: Skipping ({}) on proc({})",
+                            sbeError.what(), result.index)
+                    .c_str());
+            result.status = StopResult::Status::Skipped;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>(std::format("threadStopAll: Exception({}) on proc({})",
+                                    e.what(), result.index)
+                            .c_str());
+        result.status = StopResult::Status::Failed;
+    }
+
+    result.duration = duration_cast<milliseconds>(steady_clock::now() - start);
+    return {result, std::move(ffdc)};
+}
+
+/**
+ * @brief Creates one informational PEL listing the outcome on every
+ *        processor, with the SBE FFDC of each failure, if any of them
+ *        failed or did not finish.
+ *
+ * @param[in] procTargets - the processors
+ * @param[in] results - the outcome on each processor and its SBE FFDC,
+ *                      empty if the child stopping it crashed or did
+ *                      not finish
+ * @param[in] cmd - the SBE command, for SRC6
+ */
+static void
+    createSummaryPEL(const std::vector<struct pdbg_target*>& procTargets,
+                     const std::vector<std::optional<StopOutcome>>& results,
+                     uint32_t cmd)
+{
+    std::vector<uint32_t> failed;
+
+    // To store additional data about ffdc.
+    FFDCData pelAdditionalData;
+    FFDCSections ffdcSections;
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto index = pdbg_target_index(procTargets[i]);
+        std::string outcome;
+
+        if (!results[i])
+        {
+            outcome = std::format("crashed or not done after {}s",
+                                  threadStopAllTimeout.count());
+            failed.push_back(index);
+        }
+        else
+        {
+            const auto& [result, ffdc] = *results[i];
+            switch (result.status)
+            {
+                case StopResult::Status::Stopped:
+                    outcome = std::format("stopped in {}ms",
+                                          result.duration.count());
+                    break;
+                case StopResult::Status::Skipped:
+                    outcome = "skipped, SBE not ready";
+                    break;
+                case StopResult::Status::Failed:
+                    outcome = std::format("failed({}) in {}ms", result.errType,
+                                          result.duration.count());
+                    failed.push_back(index);
+                    if (!ffdc.empty())
+                    {
+                        ffdcSections.push_back({sbeFFDCSubType, 1, ffdc});
+                    }
+                    break;
+            }
+        }
+
+        pelAdditionalData.emplace_back(std::format("PROC{}", index), outcome);
+    }
+
+    if (failed.empty())
+    {
+        return;
+    }
+
+    // SRC6 : [0:15] chip position, setting 0xFF to indicate several chips
+    //        [16:23] command class,  [24:31] Type
+    uint32_t position = (failed.size() == 1) ? failed.front() : 0xFF;
+    pelAdditionalData.emplace_back("SRC6",
+                                   std::to_string((position << 16) | cmd));
+
+    createErrorPEL("org.open_power.Processor.Error.SbeChipOpFailure", {},
+                   pelAdditionalData, Severity::Informational, ffdcSections);
+}
+
 /**
  * @brief Stop instruction executions on all functional threads in the
  *        host processors.
@@ -29,6 +241,14 @@ using namespace phosphor::logging;
  *        Attempt best case approach. Like issue processor level stopall
  *        chip-op with ignore hardware error mode. Since this function
  *        is used in power-off/error path, ignore the internal error now.
+ *
+ *        The processors are stopped MAX_CHILD_PROCS at a time, each
+ *        from its own child process as libphal isn't thread safe.
+ *        Children still running after threadStopAllTimeout are killed,
+ *        so that power-off is not held up, and nothing is left running
+ *        when this returns.  One PEL lists the outcome on every
+ *        processor if any failed or did not finish, with the SBE FFDC
+ *        of each failure.
  */
 void threadStopAll(void)
 {
@@ -49,75 +269,20 @@ void threadStopAll(void)
             return;
         }
 
-        struct pdbg_target* procTarget;
-        ATTR_HWAS_STATE_Type hwasState;
-        pdbg_for_each_class_target("proc", procTarget)
+        std::vector<struct pdbg_target*> procTargets;
+        for (const auto& proc : ProcInventory::get().functional())
         {
-            if (DT_GET_PROP(ATTR_HWAS_STATE, procTarget, hwasState))
-            {
-                log<level::ERR>(
-                    std::format("({})Could not read HWAS_STATE attribute",
-                                pdbg_target_path(procTarget))
-                        .c_str());
-                continue;
-            }
-            if (!hwasState.functional)
-            {
-                continue;
-            }
+            // Probe here so each child below doesn't probe them again
+            pdbg_target_probe(proc.target);
+            procTargets.push_back(proc.target);
+        }
 
-            try
-            {
-                openpower::phal::sbe::threadStopProc(procTarget);
-            }
-            catch (const sbeError_t& sbeError)
-            {
-                auto errType = sbeError.errType();
-
-                // Create PEL only for  valid SBE reported failures
-                if (errType == SBE_CMD_FAILED)
-                {
-                    log<level::ERR>(
-                        std::format(
-                            "threadStopAll failed({}) on proc({})",
-                            static_cast<
-                                std::underlying_type<ipl_error_type>::type>(
-                                errType),
-                            pdbg_target_index(procTarget))
-                            .c_str());
+        auto results = util::runInChildren(
+            procTargets.size(),
+            [&](size_t i) { return stopProcThreads(procTargets[i]); },
+            MAX_CHILD_PROCS, threadStopAllTimeout);
 
-                    uint32_t index = pdbg_target_index(procTarget);
-                    // To store additional data about ffdc.
-                    FFDCData pelAdditionalData;
-
-                    // SRC6 : [0:15] chip position
-                    //        [16:23] command class,  [24:31] Type
-                    pelAdditionalData.emplace_back(
-                        "SRC6", std::to_string((index << 16) | cmd));
-
-                    // Create informational error log.
-                    createSbeErrorPEL(
-                        "org.open_power.Processor.Error.SbeChipOpFailure",
-                        sbeError, pelAdditionalData, procTarget,
-                        Severity::Informational);
-                }
-                else
-                {
-                    // SBE is not ready to accept chip-ops,
-                    // Skip the request, no additional error handling required.
-                    log<level::INFO>(
-                        std::format("threadStopAll: Skipping ({}) on proc({})",
-                                    sbeError.what(),
-                                    pdbg_target_index(procTarget))
-                            .c_str());
-                }
-                continue;
-            }
-            log<level::INFO>(
-                std::format("Processor thread stopall completed on proc({})",
-                            pdbg_target_index(procTarget))
-                    .c_str());
-        }
+        createSummaryPEL(procTargets, results, cmd);
     }
     // Capture general exception
     catch (const std::exception& ex)
@@ -148,7 +313,7 @@ void threadStopAll(void)
     }
 }
 
-REGISTER_PROCEDURE("threadStopAll", threadStopAll)
+REGISTER_STANDALONE_PROCEDURE("threadStopAll", threadStopAll)
 
 } // namespace phal
 } // namespace openpower
@@ -3,7 +3,9 @@
 #include <functional>
 #include <iostream>
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace openpower
 {
@@ -24,6 +26,30 @@ using ProcedureMap = std::map<ProcedureName, ProcedureFunction>;
         openpower::util::Registration r{std::move(name), std::move(func)};     \
     }
 
+/**
+ * Like REGISTER_PROCEDURE, for a procedure that initializes pdbg
+ * itself, for example to pick its own backend.  pdbg can only be
+ * initialized once per process, so the daemon doesn't run these, and
+ * they always run in the process that asked for them.
+ */
+#define REGISTER_STANDALONE_PROCEDURE(name, func)                              \
+    namespace func##_ns                                                        \
+    {                                                                          \
+        openpower::util::Registration r{std::move(name), std::move(func),      \
+                                        true};                                 \
+    }
+
+/**
+ * This macro can be used to register a function that drops state
+ * cached while running a procedure, such as a snapshot of the
+ * hardware, see Registration::reset().
+ */
+#define REGISTER_RESET(name, func)                                             \
+    namespace name##_reset_ns                                                  \
+    {                                                                          \
+        openpower::util::Registration::Reset r{func};                          \
+    }
+
 /**
  * Used to register procedures.  Each procedure function can then
  * be found in a map via its name.
@@ -31,15 +57,37 @@ using ProcedureMap = std::map<ProcedureName, ProcedureFunction>;
 class Registration
 {
   public:
+    /**
+     * Used to register reset functions, see REGISTER_RESET
+     */
+    struct Reset
+    {
+        /**
+         *  Adds the function to the ones reset() calls
+         *
+         *  @param[in] function - the function to call
+         */
+        explicit Reset(std::function<void()>&& function)
+        {
+            resets().push_back(std::move(function));
+        }
+    };
+
     /**
      *  Adds the procedure name and function to the internal
      *  procedure map.
      *
      *  @param[in] name - the procedure name
      *  @param[in] function - the function to run
+     *  @param[in] standalone - if it can't run in the daemon
      */
-    Registration(ProcedureName&& name, ProcedureFunction&& function)
+    Registration(ProcedureName&& name, ProcedureFunction&& function,
+                 bool standalone = false)
     {
+        if (standalone)
+        {
+            standaloneProcedures().insert(name);
+        }
         procedures().emplace(std::move(name), std::move(function));
     }
 
@@ -51,12 +99,46 @@ class Registration
         return procedures();
     }
 
+    /**
+     * Returns true if the procedure was registered with
+     * REGISTER_STANDALONE_PROCEDURE
+     */
+    static bool isStandalone(const ProcedureName& name)
+    {
+        return standaloneProcedures().contains(name);
+    }
+
+    /**
+     * Calls every function registered with REGISTER_RESET.  Done before
+     * each procedure, so that one running in the daemon never sees
+     * state cached by an earlier one.
+     */
+    static void reset()
+    {
+        for (const auto& function : resets())
+        {
+            function();
+        }
+    }
+
   private:
     static ProcedureMap& procedures()
     {
         static ProcedureMap procMap;
         return procMap;
     }
+
+    static std::set<ProcedureName>& standaloneProcedures()
+    {
+        static std::set<ProcedureName> names;
+        return names;
+    }
+
+    static std::vector<std::function<void()>>& resets()
+    {
+        static std::vector<std::function<void()>> functions;
+        return functions;
+    }
 };
 
 } // namespace util
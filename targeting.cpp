@@ -16,15 +16,22 @@
 
 #include "targeting.hpp"
 
+#include "parallel.hpp"
+
+#include <dirent.h>
 #include <endian.h>
+#include <sys/stat.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/log.hpp>
 #include <xyz/openbmc_project/Common/File/error.hpp>
 
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
-#include <regex>
+#include <mutex>
+#include <string_view>
 
 namespace openpower
 {
@@ -34,6 +41,136 @@ namespace targeting
 using namespace phosphor::logging;
 namespace file_error = sdbusplus::xyz::openbmc_project::Common::File::Error;
 
+/**
+ * Parses the position out of the name of an FSI slave device
+ * directory, which looks like slave@NN:00.
+ *
+ * @param[in] name - the directory entry name
+ *
+ * @return the position, or std::nullopt if it isn't a slave device
+ */
+static constexpr std::optional<size_t> parseSlaveName(std::string_view name)
+{
+    constexpr std::string_view prefix{"slave@"};
+    constexpr std::string_view suffix{":00"};
+
+    if ((name.size() != prefix.size() + 2 + suffix.size()) ||
+        !name.starts_with(prefix) || !name.ends_with(suffix))
+    {
+        return std::nullopt;
+    }
+
+    auto tens = name[prefix.size()];
+    auto ones = name[prefix.size() + 1];
+    if ((tens < '0') || (tens > '9') || (ones < '0') || (ones > '9'))
+    {
+        return std::nullopt;
+    }
+
+    return (tens - '0') * 10 + (ones - '0');
+}
+
+static_assert(parseSlaveName("slave@01:00") == 1);
+static_assert(parseSlaveName("slave@42:00") == 42);
+static_assert(!parseSlaveName("slave@1:00"));
+static_assert(!parseSlaveName("slave@01:01"));
+static_assert(!parseSlaveName("slave@0a:00"));
+static_assert(!parseSlaveName("rescan"));
+
+/**
+ * The FSI slaves found in a sysfs directory, kept for the life of
+ * the process so that every Targeting construction doesn't have to
+ * read the directory again.
+ */
+struct SlaveCache
+{
+    /** The directory that was read */
+    std::string dir;
+
+    /** The device, inode and modification time of the directory */
+    dev_t dev = 0;
+    ino_t ino = 0;
+    timespec mtime{};
+
+    /** The position and CFAM path of each slave found */
+    std::vector<std::pair<size_t, std::string>> slaves;
+};
+
+static std::mutex slaveCacheMutex;
+static std::optional<SlaveCache> slaveCache;
+
+/**
+ * Returns the position and CFAM path of every FSI slave in a sysfs
+ * directory, from the cache if the directory hasn't changed since
+ * it was last read.
+ *
+ * @param[in] dir - the fsi slave sysfs base directory
+ */
+static std::vector<std::pair<size_t, std::string>>
+    findSlaves(const std::string& dir)
+{
+    std::lock_guard lock{slaveCacheMutex};
+
+    struct stat st{};
+    if (stat(dir.c_str(), &st) == 0 && slaveCache && slaveCache->dir == dir &&
+        slaveCache->dev == st.st_dev && slaveCache->ino == st.st_ino &&
+        slaveCache->mtime.tv_sec == st.st_mtim.tv_sec &&
+        slaveCache->mtime.tv_nsec == st.st_mtim.tv_nsec)
+    {
+        return slaveCache->slaves;
+    }
+
+    slaveCache.reset();
+
+    auto closeDir = [](DIR* d) { closedir(d); };
+    std::unique_ptr<DIR, decltype(closeDir)> handle{opendir(dir.c_str()),
+                                                    closeDir};
+    if (!handle)
+    {
+        using metadata = xyz::openbmc_project::Common::File::Open;
+
+        elog<file_error::Open>(metadata::ERRNO(errno),
+                               metadata::PATH(dir.c_str()));
+    }
+
+    SlaveCache cache{dir, st.st_dev, st.st_ino, st.st_mtim, {}};
+
+    std::string path{std::filesystem::path{dir} / ""};
+    auto dirLength = path.size();
+
+    while (auto dirEntry = readdir(handle.get()))
+    {
+        auto pos = parseSlaveName(dirEntry->d_name);
+        if (!pos)
+        {
+            continue;
+        }
+
+        if (*pos == 0)
+        {
+            log<level::ERR>("Unexpected FSI slave device name found",
+                            entry("DEVICE_NAME=%s", dirEntry->d_name));
+            continue;
+        }
+
+        path.resize(dirLength);
+        path.append(dirEntry->d_name).append("/raw");
+
+        cache.slaves.emplace_back(*pos, path);
+    }
+
+    slaveCache = std::move(cache);
+
+    return slaveCache->slaves;
+}
+
+void Targeting::invalidate()
+{
+    std::lock_guard lock{slaveCacheMutex};
+    slaveCache.reset();
+    generation.fetch_add(1, std::memory_order_release);
+}
+
 int Target::getCFAMFD()
 {
     if (cfamFD.get() == nullptr)
@@ -45,65 +182,120 @@ int Target::getCFAMFD()
     return cfamFD->get();
 }
 
-std::unique_ptr<Target>& Targeting::getTarget(size_t pos)
+void Target::setShadowing(bool enable)
 {
-    auto search = [pos](const auto& t) { return t->getPos() == pos; };
+    shadowing = enable;
+    shadowRegs.clear();
+}
 
-    auto target = find_if(targets.begin(), targets.end(), search);
-    if (target == targets.end())
+std::optional<uint32_t> Target::getShadowReg(uint16_t address) const
+{
+    auto reg = shadowRegs.find(address);
+    if (reg == shadowRegs.end())
     {
-        throw std::runtime_error("Target not found: " + std::to_string(pos));
+        return std::nullopt;
     }
-    else
+
+    return reg->second;
+}
+
+void Target::setShadowReg(uint16_t address, uint32_t data)
+{
+    if (shadowing)
     {
-        return *target;
+        shadowRegs[address] = data;
     }
 }
 
-Targeting::Targeting(const std::string& fsiMasterDev,
-                     const std::string& fsiSlaveDir) :
-    fsiMasterPath(fsiMasterDev), fsiSlaveBasePath(fsiSlaveDir)
+Target& Targeting::getTarget(size_t pos)
 {
-    std::regex exp{"fsi1/slave@([0-9]{2}):00", std::regex::extended};
-
-    // Always create P0, the FSI master.
-    targets.push_back(std::make_unique<Target>(0, fsiMasterPath));
-    try
+    if ((pos >= positions.size()) || (positions[pos] == noTarget))
     {
-        // Find the the remaining P9s dynamically based on which files show up
-        for (auto& file : std::filesystem::directory_iterator(fsiSlaveBasePath))
+        throw TargetNotFound(pos);
+    }
+
+    return targets[positions[pos]];
+}
+
+ParallelResult Targeting::forEachParallel(const TargetFunc& func,
+                                          MasterOrder order, size_t maxWorkers)
+{
+    std::vector<std::exception_ptr> errors(targets.size());
+
+    auto run = [&](size_t index) {
+        try
         {
-            std::smatch match;
-            std::string path = file.path();
-            if (std::regex_search(path, match, exp))
-            {
-                auto pos = atoi(match[1].str().c_str());
-                if (pos == 0)
-                {
-                    log<level::ERR>("Unexpected FSI slave device name found",
-                                    entry("DEVICE_NAME=%s", path.c_str()));
-                    continue;
-                }
-
-                path += "/raw";
-
-                targets.push_back(std::make_unique<Target>(pos, path));
-            }
+            func(targets[index]);
         }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    // The targets are sorted, so the master is always at index 0
+    size_t begin = 0;
+    if (order != MasterOrder::concurrent && !targets.empty())
+    {
+        begin = 1;
     }
-    catch (const std::filesystem::filesystem_error& e)
+
+    if (order == MasterOrder::first && !targets.empty())
     {
-        using metadata = xyz::openbmc_project::Common::File::Open;
+        run(0);
+    }
 
-        elog<file_error::Open>(metadata::ERRNO(e.code().value()),
-                               metadata::PATH(e.path1().c_str()));
+    auto parallelErrors = util::runParallel(
+        targets.size() - begin,
+        [&](size_t index) { func(targets[begin + index]); }, maxWorkers);
+    std::move(parallelErrors.begin(), parallelErrors.end(),
+              errors.begin() + begin);
+
+    if (order == MasterOrder::last && !targets.empty())
+    {
+        run(0);
     }
 
-    auto sortTargets = [](const std::unique_ptr<Target>& left,
-                          const std::unique_ptr<Target>& right) {
-        return left->getPos() < right->getPos();
+    ParallelResult result;
+    for (size_t i = 0; i < errors.size(); i++)
+    {
+        if (errors[i])
+        {
+            result.errors.emplace_back(targets[i].getPos(), errors[i]);
+        }
+    }
+
+    return result;
+}
+
+Targeting::Targeting(const std::string& fsiMasterDev,
+                     const std::string& fsiSlaveDir) :
+    fsiMasterPath(fsiMasterDev), fsiSlaveBasePath(fsiSlaveDir)
+{
+    // Find the the remaining P9s dynamically based on which files show up
+    auto slaves = findSlaves(fsiSlaveBasePath);
+
+    targets.reserve(slaves.size() + 1);
+
+    // Always create P0, the FSI master.
+    targets.emplace_back(0, fsiMasterPath);
+
+    for (auto& [pos, path] : slaves)
+    {
+        targets.emplace_back(pos, std::move(path));
+    }
+
+    auto sortTargets = [](const Target& left, const Target& right) {
+        return left.getPos() < right.getPos();
     };
     std::sort(targets.begin(), targets.end(), sortTargets);
+
+    // Build the position to index lookup table
+    positions.assign(targets.back().getPos() + 1, noTarget);
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        positions[targets[i].getPos()] = i;
+    }
 }
 
 } // namespace targeting
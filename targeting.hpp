@@ -2,7 +2,15 @@
 
 #include "filedescriptor.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace openpower
@@ -33,7 +41,8 @@ class Target
 
     Target() = delete;
     ~Target() = default;
-    Target(const Target&) = default;
+    Target(const Target&) = delete;
+    Target& operator=(const Target&) = delete;
     Target(Target&&) = default;
     Target& operator=(Target&&) = default;
 
@@ -59,6 +68,40 @@ class Target
      */
     int getCFAMFD();
 
+    /**
+     * Enables or disables the shadow copy of CFAM register values
+     * kept for this target.  Disabling it drops any values cached
+     * so far.
+     *
+     * @param[in] enable - true to enable shadowing
+     */
+    void setShadowing(bool enable);
+
+    /**
+     * Returns true if shadowing of CFAM register values is enabled
+     */
+    inline auto isShadowing() const
+    {
+        return shadowing;
+    }
+
+    /**
+     * Returns the last known value of a CFAM register, if shadowing
+     * is enabled and the register has been accessed since.
+     *
+     * @param[in] address - the CFAM register address
+     */
+    std::optional<uint32_t> getShadowReg(uint16_t address) const;
+
+    /**
+     * Records the last known value of a CFAM register.  Does nothing
+     * if shadowing is disabled.
+     *
+     * @param[in] address - the CFAM register address
+     * @param[in] data - the register value
+     */
+    void setShadowReg(uint16_t address, uint32_t data);
+
   private:
     /**
      * The logical position of this target
@@ -68,12 +111,94 @@ class Target
     /**
      * The sysfs device path for the CFAM
      */
-    const std::string cfamPath;
+    std::string cfamPath;
 
     /**
      * The file descriptor to use for read/writeCFAMReg
      */
     std::unique_ptr<openpower::util::FileDescriptor> cfamFD;
+
+    /**
+     * If the last known CFAM register values are being tracked
+     */
+    bool shadowing = false;
+
+    /**
+     * The last known CFAM register values, by address
+     */
+    std::map<uint16_t, uint32_t> shadowRegs;
+};
+
+/**
+ * How Targeting::forEachParallel orders the work on the master
+ * processor (position 0) relative to the other processors.
+ */
+enum class MasterOrder
+{
+    /** The master is done on its own before any of the others */
+    first,
+    /** The master is done along with the others */
+    concurrent,
+    /** The master is done on its own after all of the others */
+    last
+};
+
+/**
+ * The outcome of a Targeting::forEachParallel call.
+ */
+struct ParallelResult
+{
+    /**
+     * The exceptions thrown by the callable, as pairs of
+     * target position and exception, in position order.
+     */
+    std::vector<std::pair<size_t, std::exception_ptr>> errors;
+
+    /**
+     * Returns true if the callable succeeded on every target
+     */
+    inline bool ok() const
+    {
+        return errors.empty();
+    }
+
+    /**
+     * Rethrows the exception of the lowest position target that
+     * failed, if any.
+     */
+    void rethrowFirst() const
+    {
+        if (!errors.empty())
+        {
+            std::rethrow_exception(errors.front().second);
+        }
+    }
+};
+
+/**
+ * Thrown by Targeting::getTarget when there is no target at
+ * the requested position.
+ */
+class TargetNotFound : public std::exception
+{
+  public:
+    explicit TargetNotFound(size_t position) : pos(position) {}
+
+    const char* what() const noexcept override
+    {
+        return "Target not found";
+    }
+
+    /**
+     * Returns the position that was requested
+     */
+    inline auto getPos() const
+    {
+        return pos;
+    }
+
+  private:
+    size_t pos;
 };
 
 /**
@@ -93,24 +218,25 @@ class Targeting
     Targeting() : Targeting(fsiMasterDevPath, fsiSlaveBaseDir) {}
 
     ~Targeting() = default;
-    Targeting(const Targeting&) = default;
+    Targeting(const Targeting&) = delete;
+    Targeting& operator=(const Targeting&) = delete;
     Targeting(Targeting&&) = default;
     Targeting& operator=(Targeting&&) = default;
 
     /**
-     * Returns a const iterator to the first target
+     * Returns an iterator to the first target
      */
     inline auto begin()
     {
-        return targets.cbegin();
+        return targets.begin();
     }
 
     /**
-     * Returns a const iterator to the last (highest position) target.
+     * Returns an iterator past the last (highest position) target.
      */
     inline auto end()
     {
-        return targets.cend();
+        return targets.end();
     }
 
     /**
@@ -123,10 +249,64 @@ class Targeting
 
     /**
      * Returns a target by position.
+     *
+     * Throws TargetNotFound if there isn't one.
+     */
+    Target& getTarget(size_t pos);
+
+    /**
+     * The callable run on each target by forEachParallel
+     */
+    using TargetFunc = std::function<void(Target&)>;
+
+    /**
+     * The default upper bound on the forEachParallel worker threads
      */
-    std::unique_ptr<Target>& getTarget(size_t pos);
+    static constexpr size_t defaultMaxWorkers = 8;
+
+    /**
+     * Runs a callable on every target, on up to maxWorkers threads
+     * at a time (the calling thread included).  Each target is only
+     * ever used by one thread, so the callable may use the CFAM
+     * access functions on it without any locking, but anything else
+     * it touches has to be thread safe.
+     *
+     * An exception thrown by the callable does not stop the other
+     * targets from being processed; it is returned in the result.
+     *
+     * @param[in] func - the callable to run on each target
+     * @param[in] order - when the master is processed
+     * @param[in] maxWorkers - the maximum number of threads to use
+     *
+     * @return ParallelResult - the exceptions thrown, by position
+     */
+    ParallelResult forEachParallel(const TargetFunc& func,
+                                   MasterOrder order = MasterOrder::first,
+                                   size_t maxWorkers = defaultMaxWorkers);
+
+    /**
+     * Drops the FSI slaves found by previous constructions, so the
+     * next one scans sysfs again.  Must be called after anything
+     * that can change the set of slaves, like an FSI scan or a CFAM
+     * reset.
+     */
+    static void invalidate();
+
+    /**
+     * Returns the number of invalidate() calls so far, so that other
+     * caches of FSI state can tell when they have gone stale.
+     */
+    static uint64_t getGeneration()
+    {
+        return generation.load(std::memory_order_acquire);
+    }
 
   private:
+    /**
+     * The number of invalidate() calls
+     */
+    static inline std::atomic<uint64_t> generation{0};
+
     /**
      * The path to the fsi-master sysfs device to access
      */
@@ -138,9 +318,20 @@ class Targeting
     std::string fsiSlaveBasePath;
 
     /**
-     * A container of Targets in the system
+     * The Targets in the system, sorted by position
+     */
+    std::vector<Target> targets;
+
+    /**
+     * The index in targets of the Target at each position,
+     * or noTarget if there isn't one.
+     */
+    std::vector<size_t> positions;
+
+    /**
+     * The positions entry for a position without a Target
      */
-    std::vector<std::unique_ptr<Target>> targets;
+    static constexpr size_t noTarget = SIZE_MAX;
 };
 
 } // namespace targeting
@@ -1,11 +1,15 @@
 #include "temporary_file.hpp"
 
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 
 #include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
@@ -13,11 +17,35 @@ namespace openpower::util
 {
 using namespace phosphor::logging;
 
-TemporaryFile::TemporaryFile()
+/**
+ * Flushes a file or directory to storage.
+ *
+ * Throws an exception if an error occurs.
+ */
+static void syncPath(const fs::path& path, int flags)
+{
+    int fd = open(path.c_str(), flags | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::runtime_error{"Unable to open " + path.string() + ": " +
+                                 strerror(errno)};
+    }
+
+    int rc = fsync(fd);
+    int savedErrno = errno;
+    close(fd);
+
+    if (rc == -1)
+    {
+        throw std::runtime_error{"Unable to sync " + path.string() + ": " +
+                                 strerror(savedErrno)};
+    }
+}
+
+TemporaryFile::TemporaryFile(const fs::path& directory)
 {
     // Build template path required by mkstemp()
-    std::string templatePath =
-        fs::temp_directory_path() / "openpower-proc-control-XXXXXX";
+    std::string templatePath = directory / "openpower-proc-control-XXXXXX";
 
     // Generate unique file name, create file, and open it.  The XXXXXX
     // characters are replaced by mkstemp() to make the file name unique.
@@ -60,4 +88,54 @@ void TemporaryFile::remove()
     }
 }
 
+void TemporaryFile::copyFrom(const fs::path& source)
+{
+    int src = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src == -1)
+    {
+        throw std::runtime_error{"Unable to open " + source.string() + ": " +
+                                 strerror(errno)};
+    }
+
+    int dst = open(path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (dst == -1)
+    {
+        int savedErrno = errno;
+        close(src);
+        throw std::runtime_error{
+            std::string{"Unable to open temporary file: "} +
+            strerror(savedErrno)};
+    }
+
+    // Share the blocks if the file system can, otherwise copy them
+    bool cloned = (ioctl(dst, FICLONE, src) == 0);
+    close(dst);
+    close(src);
+
+    if (!cloned)
+    {
+        fs::copy_file(source, path, fs::copy_options::overwrite_existing);
+    }
+}
+
+void TemporaryFile::moveTo(const fs::path& destination)
+{
+    // Keep the permissions of the file being replaced, not the owner only
+    // permissions mkstemp() created the temporary file with
+    std::error_code ec;
+    auto status = fs::status(destination, ec);
+    if (!ec && fs::exists(status))
+    {
+        fs::permissions(path, status.permissions());
+    }
+
+    syncPath(path, O_RDONLY);
+
+    fs::rename(path, destination);
+    path.clear();
+
+    auto directory = fs::absolute(destination).parent_path();
+    syncPath(directory, O_RDONLY | O_DIRECTORY);
+}
+
 } // namespace openpower::util
@@ -16,8 +16,9 @@ namespace fs = std::filesystem;
  * The temporary file is created by the constructor.  The absolute path to the
  * file can be obtained using getPath().
  *
- * The temporary file can be deleted by calling remove().  Otherwise the file
- * will be deleted by the destructor.
+ * The temporary file can be deleted by calling remove(), or moved over
+ * another file by calling moveTo().  Otherwise the file will be deleted by
+ * the destructor.
  *
  */
 class TemporaryFile
@@ -35,7 +36,19 @@ class TemporaryFile
      *
      * Throws an exception if the file cannot be created.
      */
-    TemporaryFile();
+    TemporaryFile() : TemporaryFile(fs::temp_directory_path()) {}
+
+    /**
+     * Constructor.
+     *
+     * Creates a temporary file in the specified directory, so that it can
+     * later replace a file in that directory with moveTo().
+     *
+     * Throws an exception if the file cannot be created.
+     *
+     * @param[in] directory - directory to create the file in
+     */
+    explicit TemporaryFile(const fs::path& directory);
 
     /**
      * Destructor.
@@ -63,6 +76,36 @@ class TemporaryFile
      */
     void remove();
 
+    /**
+     * Replaces the contents of the temporary file with a copy of the source
+     * file.
+     *
+     * The copy shares the source file's blocks (FICLONE) when the file
+     * system supports it, and is a regular copy otherwise.
+     *
+     * Throws an exception if an error occurs.
+     *
+     * @param[in] source - file to copy
+     */
+    void copyFrom(const fs::path& source);
+
+    /**
+     * Atomically replaces the destination file with the temporary file.
+     *
+     * The temporary file is flushed to storage before it is renamed over the
+     * destination, and the rename is flushed after, so a crash leaves either
+     * the old or the new destination file.  The destination must be in the
+     * same file system, normally the same directory.
+     *
+     * Afterwards the temporary file no longer exists and getPath() returns an
+     * empty path.
+     *
+     * Throws an exception if an error occurs.
+     *
+     * @param[in] destination - file to replace
+     */
+    void moveTo(const fs::path& destination);
+
     /**
      * Returns the absolute path to the temporary file.
      *
@@ -0,0 +1,103 @@
+/**
+ * Measures how long it takes to construct a Targeting object
+ * against FSI slave directories of different sizes, both when the
+ * directory has to be read and when the previous results are used.
+ */
+#include "targeting.hpp"
+
+#include <stdlib.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace openpower::targeting;
+
+constexpr auto iterations = 2000;
+
+/**
+ * Returns the average time, in microseconds, to construct a
+ * Targeting object against the slave directory.
+ *
+ * @param[in] slaveDir - the fsi slave directory
+ * @param[in] cached - if the previous results may be used
+ */
+static double measure(const std::filesystem::path& slaveDir, bool cached)
+{
+    using namespace std::chrono;
+
+    // Make sure the cache holds this directory before timing it
+    Targeting{"/tmp", slaveDir};
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        if (!cached)
+        {
+            Targeting::invalidate();
+        }
+
+        Targeting targets{"/tmp", slaveDir};
+        if (targets.size() == 0)
+        {
+            std::abort();
+        }
+    }
+
+    duration<double, std::micro> elapsed = steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main()
+{
+    char dir[] = "/tmp/targetingBenchXXXXXX";
+    if (mkdtemp(dir) == nullptr)
+    {
+        std::cerr << "mkdtemp failed: " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    std::filesystem::path slaveDir{dir};
+
+    std::cout << std::setw(10) << "entries" << std::setw(10) << "slaves"
+              << std::setw(14) << "scan (us)" << std::setw(14)
+              << "cached (us)" << "\n";
+
+    size_t entries = 0;
+    size_t slaves = 0;
+    for (auto size : {4, 16, 64, 256, 1024})
+    {
+        // Mix slave devices in with the other sysfs attributes
+        // that live in the same directory.
+        for (; entries < static_cast<size_t>(size); entries++)
+        {
+            std::string name;
+            if ((entries % 4 == 0) && (slaves < 99))
+            {
+                slaves++;
+                name = "slave@" + std::string(slaves < 10 ? "0" : "") +
+                       std::to_string(slaves) + ":00";
+            }
+            else
+            {
+                name = "attr" + std::to_string(entries);
+            }
+
+            std::ofstream(slaveDir / name);
+        }
+
+        std::cout << std::setw(10) << entries << std::setw(10) << slaves
+                  << std::fixed << std::setprecision(2) << std::setw(14)
+                  << measure(slaveDir, false) << std::setw(14)
+                  << measure(slaveDir, true) << "\n";
+    }
+
+    std::filesystem::remove_all(slaveDir);
+
+    return 0;
+}
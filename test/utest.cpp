@@ -13,18 +13,36 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cfam_access.hpp"
+#include "extensions/phal/clock_sampler.hpp"
+#include "extensions/phal/clock_snapshot.hpp"
+#include "extensions/phal/devtree_patch.hpp"
+#include "extensions/phal/fdt_file.hpp"
+#include "extensions/phal/trace_buffer.hpp"
+#include "memory_file.hpp"
+#include "parallel.hpp"
 #include "registration.hpp"
 #include "targeting.hpp"
+#include "temporary_file.hpp"
+#include "timing.hpp"
 
+#include <fcntl.h>
 #include <stdlib.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 
 #include <gtest/gtest.h>
 
 using namespace openpower::util;
 using namespace openpower::targeting;
+using namespace openpower::cfam::access;
 
 constexpr auto masterDir = "/tmp";
 
@@ -64,9 +82,9 @@ TEST_F(TargetingTest, CreateTargets)
         ASSERT_EQ(targets.size(), 1);
 
         auto t = targets.begin();
-        ASSERT_EQ((*t)->getPos(), 0);
+        ASSERT_EQ(t->getPos(), 0);
 
-        ASSERT_EQ((*t)->getCFAMPath(), masterDir);
+        ASSERT_EQ(t->getCFAMPath(), masterDir);
     }
 
     // Test that we can create multiple Targets
@@ -87,7 +105,7 @@ TEST_F(TargetingTest, CreateTargets)
         {
             std::filesystem::path path;
 
-            ASSERT_EQ(t->getPos(), i);
+            ASSERT_EQ(t.getPos(), i);
 
             if (0 == i)
             {
@@ -102,12 +120,235 @@ TEST_F(TargetingTest, CreateTargets)
                 path /= subdir.str();
             }
 
-            ASSERT_EQ(t->getCFAMPath(), path);
+            ASSERT_EQ(t.getCFAMPath(), path);
             i++;
         }
     }
 }
 
+TEST_F(TargetingTest, IgnoreOtherEntries)
+{
+    std::ofstream(_slaveDir / "slave@02:00");
+    std::ofstream(_slaveDir / "slave@2:00");
+    std::ofstream(_slaveDir / "slave@03:01");
+    std::ofstream(_slaveDir / "slave@0x:00");
+    std::ofstream(_slaveDir / "slave@04:00.old");
+    std::ofstream(_slaveDir / "slave@00:00");
+    std::ofstream(_slaveDir / "rescan");
+
+    Targeting targets{masterDir, _slaveDir};
+
+    ASSERT_EQ(targets.size(), 2);
+    ASSERT_EQ(targets.getTarget(2).getCFAMPath(),
+              _slaveDir / "slave@02:00/raw");
+
+    // A new slave is found once the previous results are dropped
+    std::ofstream(_slaveDir / "slave@05:00");
+    Targeting::invalidate();
+
+    Targeting rescanned{masterDir, _slaveDir};
+    ASSERT_EQ(rescanned.size(), 3);
+    ASSERT_EQ(rescanned.getTarget(5).getPos(), 5);
+}
+
+TEST_F(TargetingTest, GetTarget)
+{
+    std::ofstream(_slaveDir / "slave@01:00");
+    std::ofstream(_slaveDir / "slave@03:00");
+
+    Targeting targets{masterDir, _slaveDir};
+
+    ASSERT_EQ(targets.getTarget(0).getCFAMPath(), masterDir);
+    ASSERT_EQ(targets.getTarget(1).getPos(), 1);
+    ASSERT_EQ(targets.getTarget(3).getPos(), 3);
+
+    // Missing positions, inside and beyond the range of positions
+    EXPECT_THROW(targets.getTarget(2), TargetNotFound);
+    EXPECT_THROW(targets.getTarget(4), TargetNotFound);
+
+    try
+    {
+        targets.getTarget(2);
+    }
+    catch (const TargetNotFound& e)
+    {
+        ASSERT_EQ(e.getPos(), 2);
+    }
+}
+
+TEST_F(TargetingTest, ForEachParallel)
+{
+    std::ofstream(_slaveDir / "slave@01:00");
+    std::ofstream(_slaveDir / "slave@02:00");
+    std::ofstream(_slaveDir / "slave@03:00");
+
+    Targeting targets{masterDir, _slaveDir};
+
+    // Every target is visited once, and failures are collected in
+    // position order without stopping the others.
+    {
+        std::mutex lock;
+        std::vector<size_t> visited;
+
+        auto result = targets.forEachParallel(
+            [&](auto& t) {
+                {
+                    std::lock_guard guard{lock};
+                    visited.push_back(t.getPos());
+                }
+
+                if (t.getPos() % 2)
+                {
+                    throw std::runtime_error("failed");
+                }
+            },
+            MasterOrder::concurrent, 2);
+
+        std::sort(visited.begin(), visited.end());
+        ASSERT_EQ(visited, (std::vector<size_t>{0, 1, 2, 3}));
+
+        ASSERT_FALSE(result.ok());
+        ASSERT_EQ(result.errors.size(), 2);
+        EXPECT_EQ(result.errors[0].first, 1);
+        EXPECT_EQ(result.errors[1].first, 3);
+        EXPECT_THROW(result.rethrowFirst(), std::runtime_error);
+    }
+
+    // The master is done alone before or after the others
+    for (auto order : {MasterOrder::first, MasterOrder::last})
+    {
+        std::mutex lock;
+        std::vector<size_t> visited;
+
+        auto result = targets.forEachParallel(
+            [&](auto& t) {
+                std::lock_guard guard{lock};
+                visited.push_back(t.getPos());
+            },
+            order);
+
+        ASSERT_TRUE(result.ok());
+        ASSERT_EQ(visited.size(), 4);
+        if (order == MasterOrder::first)
+        {
+            EXPECT_EQ(visited.front(), 0);
+        }
+        else
+        {
+            EXPECT_EQ(visited.back(), 0);
+        }
+    }
+}
+
+class CFAMAccessTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        char file[50];
+        strcpy(file, masterDir);
+        strcat(file, "/cfamXXXXXX");
+
+        auto fd = mkstemp(file);
+        assert(fd >= 0);
+        close(fd);
+
+        _cfamFile = file;
+        _target = std::make_unique<Target>(0, _cfamFile);
+    }
+
+    virtual void TearDown()
+    {
+        _target.reset();
+        std::filesystem::remove(_cfamFile);
+    }
+
+    std::filesystem::path _cfamFile;
+    std::unique_ptr<Target> _target;
+};
+
+TEST_F(CFAMAccessTest, ReadWrite)
+{
+    writeReg(*_target, 0x2801, 0x12345678);
+    ASSERT_EQ(readReg(*_target, 0x2801), 0x12345678);
+
+    writeRegWithMask(*_target, 0x2801, 0x0000FFFF, 0x00FF00FF);
+    ASSERT_EQ(readReg(*_target, 0x2801), 0x120056FF);
+
+    // The device sees the data big endian at the translated offset
+    uint8_t raw[4] = {};
+    std::ifstream file(_cfamFile, std::ios::binary);
+    file.seekg(0x2804);
+    file.read(reinterpret_cast<char*>(raw), sizeof(raw));
+    ASSERT_EQ(raw[0], 0x12);
+    ASSERT_EQ(raw[3], 0xFF);
+}
+
+TEST_F(CFAMAccessTest, Transaction)
+{
+    Transaction transaction{*_target};
+
+    // Consecutive registers, across a 0x400 block boundary
+    transaction.write(0x13FE, 0x11111111)
+        .write(0x13FF, 0x22222222)
+        .write(0x1400, 0x33333333)
+        .writeWithMask(0x13FF, 0xFFFFFFFF, 0x0000FF00)
+        .read(0x13FE)
+        .read(0x13FF)
+        .read(0x1400);
+
+    auto results = transaction.submit();
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0], 0x11111111);
+    EXPECT_EQ(results[1], 0x2222FF22);
+    EXPECT_EQ(results[2], 0x33333333);
+
+    // The queue is empty after a submit
+    ASSERT_TRUE(transaction.submit().empty());
+
+    ASSERT_EQ(readReg(*_target, 0x13FF), 0x2222FF22);
+}
+
+TEST_F(CFAMAccessTest, ShadowRegs)
+{
+    auto corrupt = [this](size_t offset) {
+        std::fstream file(_cfamFile,
+                          std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(offset);
+        file.write("\xAA\xAA\xAA\xAA", 4);
+    };
+
+    _target->setShadowing(true);
+
+    // P9_CBS_CS is not volatile, so the second masked write uses the
+    // value left by the first one instead of what is in the hardware.
+    writeReg(*_target, 0x2801, 0x00000001);
+    corrupt(0x2804);
+    writeRegWithMask(*_target, 0x2801, 0x80000000, 0x80000000);
+    ASSERT_EQ(readReg(*_target, 0x2801), 0x80000001);
+
+    // P9_SBE_MSG_REGISTER is volatile, so it is always read
+    writeReg(*_target, 0x2809, 0x00000001);
+    corrupt(0x2824);
+    writeRegWithMask(*_target, 0x2809, 0x00000000, 0x0000000F);
+    ASSERT_EQ(readReg(*_target, 0x2809), 0xAAAAAAA0);
+
+    // 0x13FF and 0x2000 are next to each other in the device, so they
+    // are written together, and each keeps its own shadow value.
+    Transaction transaction{*_target};
+    transaction.write(0x13FF, 0x11111111).write(0x2000, 0x22222222).submit();
+    EXPECT_EQ(_target->getShadowReg(0x13FF), 0x11111111);
+    EXPECT_EQ(_target->getShadowReg(0x2000), 0x22222222);
+    EXPECT_FALSE(_target->getShadowReg(0x1400));
+
+    // Without shadowing the hardware is always read
+    _target->setShadowing(false);
+    ASSERT_FALSE(_target->getShadowReg(0x2801));
+    corrupt(0x2804);
+    writeRegWithMask(*_target, 0x2801, 0x00000000, 0x0000000F);
+    ASSERT_EQ(readReg(*_target, 0x2801), 0xAAAAAAA0);
+}
+
 void func1()
 {
     std::cout << "Hello\n";
@@ -118,8 +359,76 @@ void func2()
     std::cout << "World\n";
 }
 
+int resets = 0;
+
+void resetCount()
+{
+    resets++;
+}
+
 REGISTER_PROCEDURE("hello", func1)
-REGISTER_PROCEDURE("world", func2)
+REGISTER_STANDALONE_PROCEDURE("world", func2)
+REGISTER_RESET(count, resetCount)
+
+TEST(RunInChildrenTest, Results)
+{
+    struct Result
+    {
+        size_t index;
+        pid_t pid;
+    };
+
+    auto parent = getpid();
+    auto results = runInChildren(
+        6,
+        [](size_t index) {
+            if (index == 3)
+            {
+                throw std::runtime_error("failed");
+            }
+            if (index == 4)
+            {
+                abort();
+            }
+            if (index == 5)
+            {
+                sleep(10);
+            }
+            return Result{index, getpid()};
+        },
+        2, std::chrono::milliseconds(500));
+
+    ASSERT_EQ(results.size(), 6);
+    for (size_t i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(results[i]);
+        EXPECT_EQ(results[i]->index, i);
+        EXPECT_NE(results[i]->pid, parent);
+    }
+
+    // Threw, crashed and was killed at the deadline
+    EXPECT_FALSE(results[3]);
+    EXPECT_FALSE(results[4]);
+    EXPECT_FALSE(results[5]);
+
+    // With variable size data
+    auto withData = runInChildren(
+        3,
+        [](size_t index) {
+            return std::make_pair(Result{index, getpid()},
+                                  std::vector<uint8_t>(index * 1000, 0xA5));
+        },
+        3, std::chrono::seconds(5));
+
+    ASSERT_EQ(withData.size(), 3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(withData[i]);
+        EXPECT_EQ(withData[i]->first.index, i);
+        EXPECT_EQ(withData[i]->second,
+                  std::vector<uint8_t>(i * 1000, 0xA5));
+    }
+}
 
 TEST(RegistrationTest, TestReg)
 {
@@ -132,4 +441,620 @@ TEST(RegistrationTest, TestReg)
     }
 
     ASSERT_EQ(count, 2);
+    EXPECT_FALSE(Registration::isStandalone("hello"));
+    EXPECT_TRUE(Registration::isStandalone("world"));
+
+    Registration::reset();
+    EXPECT_EQ(resets, 1);
+}
+
+TEST(TraceBufferTest, AddAndClear)
+{
+    openpower::pel::TraceBuffer traces;
+    std::vector<std::pair<std::string, std::string>> data;
+
+    traces.add("first");
+    traces.add(std::string(openpower::pel::TraceBuffer::maxLength + 10, 'x'));
+    traces.appendTo(data);
+
+    ASSERT_EQ(data.size(), 2);
+    EXPECT_TRUE(data[0].first.starts_with("LOG000 "));
+    EXPECT_EQ(data[0].second, "first");
+    EXPECT_TRUE(data[1].first.starts_with("LOG001 "));
+    EXPECT_EQ(data[1].second.size(), openpower::pel::TraceBuffer::maxLength);
+
+    // Numbering starts over after a clear
+    traces.clear();
+    data.clear();
+    traces.appendTo(data);
+    ASSERT_TRUE(data.empty());
+
+    traces.add("second");
+    traces.appendTo(data);
+    ASSERT_EQ(data.size(), 1);
+    EXPECT_TRUE(data[0].first.starts_with("LOG000 "));
+    EXPECT_EQ(data[0].second, "second");
+}
+
+TEST(TraceBufferTest, Wrap)
+{
+    using openpower::pel::TraceBuffer;
+    TraceBuffer traces;
+    std::vector<std::pair<std::string, std::string>> data;
+
+    // Only the newest lines are kept, from several threads at once
+    constexpr size_t threads = 4;
+    constexpr size_t lines = TraceBuffer::capacity;
+    {
+        std::vector<std::jthread> writers;
+        for (size_t t = 0; t < threads; t++)
+        {
+            writers.emplace_back([&traces, t]() {
+                for (size_t i = 0; i < lines; i++)
+                {
+                    traces.add(std::to_string(t) + ":" + std::to_string(i));
+                }
+            });
+        }
+    }
+
+    traces.add("last");
+    traces.appendTo(data);
+
+    ASSERT_EQ(data.size(), TraceBuffer::capacity);
+    EXPECT_TRUE(data.front().first.starts_with(
+        "LOG" + std::to_string(threads * lines + 1 - TraceBuffer::capacity)));
+    EXPECT_EQ(data.back().second, "last");
+}
+
+TEST(TraceBufferTest, Serialize)
+{
+    using openpower::pel::TraceBuffer;
+    TraceBuffer traces;
+
+    std::vector<uint8_t> empty{'P', 'T', 'R', 'C', TraceBuffer::formatVersion,
+                               0,   0,   0};
+    EXPECT_EQ(traces.serialize(), empty);
+
+    traces.add("ab");
+    traces.add("c");
+    auto data = traces.serialize();
+
+    // header, then 2 lines of 14 bytes plus the text
+    ASSERT_EQ(data.size(), 8 + 14 + 1 + 14 + 2);
+    EXPECT_EQ(data[6], 0);
+    EXPECT_EQ(data[7], 2);
+
+    // Newest first
+    EXPECT_EQ(data[11], 1);
+    EXPECT_EQ(data[21], 1);
+    EXPECT_EQ(data[22], 'c');
+    EXPECT_EQ(data[26], 0);
+    EXPECT_EQ(data[36], 2);
+    EXPECT_EQ(std::string(data.begin() + 37, data.end()), "ab");
+}
+
+TEST(MemoryFileTest, ReadBack)
+{
+    std::string contents{"some ffdc"};
+    MemoryFile file{"utest", contents};
+
+    ASSERT_GE(file.getFD(), 0);
+
+    // A new descriptor, as the logging service gets, reads it all
+    int fd = dup(file.getFD());
+    ASSERT_GE(fd, 0);
+
+    std::string data(contents.size() + 1, '\0');
+    auto rc = read(fd, data.data(), data.size());
+    ASSERT_EQ(rc, static_cast<ssize_t>(contents.size()));
+    data.resize(rc);
+    EXPECT_EQ(data, contents);
+
+    if (file.isSealed())
+    {
+        EXPECT_EQ(write(fd, "x", 1), -1);
+        EXPECT_EQ(errno, EPERM);
+    }
+
+    close(fd);
+}
+
+TEST(TemporaryFileTest, CopyAndMove)
+{
+    namespace fs = std::filesystem;
+
+    char dir[] = "/tmp/temporaryFileTestXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    fs::path source = fs::path{dir} / "source";
+    fs::path destination = fs::path{dir} / "destination";
+    std::ofstream(source) << "new contents";
+    std::ofstream(destination) << "old contents";
+    fs::permissions(destination, fs::perms::owner_read |
+                                     fs::perms::owner_write |
+                                     fs::perms::group_read);
+
+    {
+        openpower::util::TemporaryFile file{dir};
+        EXPECT_EQ(file.getPath().parent_path(), fs::path{dir});
+
+        file.copyFrom(source);
+        file.moveTo(destination);
+        EXPECT_TRUE(file.getPath().empty());
+    }
+
+    std::ifstream in{destination};
+    std::string contents{std::istreambuf_iterator<char>{in}, {}};
+    EXPECT_EQ(contents, "new contents");
+    EXPECT_EQ(fs::status(destination).permissions(),
+              fs::perms::owner_read | fs::perms::owner_write |
+                  fs::perms::group_read);
+    EXPECT_EQ(std::distance(fs::directory_iterator{dir}, {}), 2);
+
+    fs::remove_all(dir);
+}
+
+/**
+ * Builds a small devtree blob:
+ *   / { reg = <0x12345678>;
+ *       proc0 { ATTR_X = [01]; };
+ *       proc1 { ATTR_X = [00]; ATTR_Y = <0x0102>; }; }
+ */
+static std::vector<uint8_t> makeDevtree()
+{
+    std::vector<uint8_t> blob(56, 0);
+    auto put = [&blob](uint32_t value, size_t size = 4) {
+        for (size_t i = size; i > 0; i--)
+        {
+            blob.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+        }
+    };
+    auto putName = [&blob](std::string_view name) {
+        blob.insert(blob.end(), name.begin(), name.end());
+        blob.resize((blob.size() + name.empty() + 4) & ~3);
+    };
+    auto putProp = [&](uint32_t nameOff, uint32_t value, size_t size) {
+        put(3);
+        put(size);
+        put(nameOff);
+        put(value, size);
+        blob.resize((blob.size() + 3) & ~3);
+    };
+
+    put(1);
+    putName("");
+    putProp(0, 0x12345678, 4);
+    put(1);
+    putName("proc0");
+    putProp(4, 1, 1);
+    put(4);
+    put(2);
+    put(1);
+    putName("proc1");
+    putProp(4, 0, 1);
+    putProp(11, 0x0102, 2);
+    put(2);
+    put(2);
+    put(9);
+    size_t structSize = blob.size() - 56;
+    std::string strings{"reg\0ATTR_X\0ATTR_Y", 18};
+    blob.insert(blob.end(), strings.begin(), strings.end());
+
+    auto header = std::vector<uint32_t>{0xD00DFEED,
+                                        static_cast<uint32_t>(blob.size()),
+                                        56,
+                                        static_cast<uint32_t>(56 + structSize),
+                                        40,
+                                        17,
+                                        16,
+                                        0,
+                                        static_cast<uint32_t>(strings.size()),
+                                        static_cast<uint32_t>(structSize)};
+    for (size_t i = 0; i < header.size(); i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            blob[i * 4 + j] = static_cast<uint8_t>(header[i] >> (24 - 8 * j));
+        }
+    }
+
+    return blob;
+}
+
+/**
+ * Writes data to a new temporary file and returns its path
+ */
+static std::string writeTempFile(const std::vector<uint8_t>& data)
+{
+    char path[] = "/tmp/devtreeTestXXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(write(fd, data.data(), data.size()),
+              static_cast<ssize_t>(data.size()));
+    close(fd);
+    return path;
+}
+
+TEST(FdtFileTest, Walk)
+{
+    using Type = openpower::phal::FdtFile::Token::Type;
+
+    auto blob = makeDevtree();
+    auto path = writeTempFile(blob);
+
+    {
+        openpower::phal::FdtFile fdt{path};
+        EXPECT_EQ(fdt.getData().size(), blob.size());
+
+        size_t pos = 0;
+        auto token = fdt.next(pos);
+        EXPECT_EQ(token.type, Type::BeginNode);
+        EXPECT_EQ(token.name, "");
+
+        token = fdt.next(pos);
+        EXPECT_EQ(token.type, Type::Property);
+        EXPECT_EQ(token.name, "reg");
+        ASSERT_EQ(token.value.size(), 4);
+        EXPECT_EQ(token.value[0], 0x12);
+        EXPECT_EQ(blob[token.offset + 3], 0x78);
+
+        token = fdt.next(pos);
+        EXPECT_EQ(token.type, Type::BeginNode);
+        EXPECT_EQ(token.name, "proc0");
+
+        token = fdt.next(pos);
+        EXPECT_EQ(token.type, Type::Property);
+        EXPECT_EQ(token.name, "ATTR_X");
+        ASSERT_EQ(token.value.size(), 1);
+        EXPECT_EQ(token.value[0], 1);
+
+        EXPECT_EQ(fdt.next(pos).type, Type::EndNode);
+        EXPECT_EQ(fdt.next(pos).type, Type::BeginNode);
+        EXPECT_EQ(fdt.next(pos).type, Type::Property);
+        EXPECT_EQ(fdt.next(pos).type, Type::Property);
+        EXPECT_EQ(fdt.next(pos).type, Type::EndNode);
+        EXPECT_EQ(fdt.next(pos).type, Type::EndNode);
+        EXPECT_EQ(fdt.next(pos).type, Type::End);
+        EXPECT_EQ(fdt.next(pos).type, Type::End);
+    }
+
+    // Not a devtree
+    blob[0] = 0;
+    std::filesystem::remove(path);
+    path = writeTempFile(blob);
+    EXPECT_THROW(openpower::phal::FdtFile{path}, std::runtime_error);
+
+    std::filesystem::remove(path);
+}
+
+TEST(DevtreePatchTest, Update)
+{
+    using namespace openpower::phal;
+
+    auto readBack = [](const std::string& path) {
+        std::ifstream file{path, std::ios::binary};
+        return std::vector<uint8_t>{std::istreambuf_iterator<char>(file),
+                                    std::istreambuf_iterator<char>()};
+    };
+    auto rewrite = [](const std::string& path,
+                      const std::vector<uint8_t>& data) {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    };
+
+    EXPECT_EQ(getPreservedAttrs("Y\n# ATTR_X\n\n  ATTR_W extra\n"),
+              (std::set<std::string, std::less<>>{"ATTR_W", "ATTR_Y", "Y"}));
+
+    // proc0 ATTR_X is at 104, proc1 ATTR_Y's name offset at 152 and its
+    // value at 156
+    auto roBlob = makeDevtree();
+    ASSERT_EQ(roBlob[104], 1);
+    ASSERT_EQ(roBlob[155], 11);
+    ASSERT_EQ(roBlob[156], 0x01);
+
+    // The r/w devtree as last built, with its preserved ATTR_Y value
+    auto rwBlob = roBlob;
+    rwBlob[156] = 0xAA;
+    rwBlob[157] = 0xBB;
+
+    std::string list{"Y\n"};
+    auto roPath = writeTempFile(roBlob);
+    auto rwPath = writeTempFile(rwBlob);
+
+    {
+        FdtFile ro{roPath};
+        Fingerprint built;
+        {
+            FdtFile rw{rwPath};
+            built = getFingerprint(ro, list, rw);
+        }
+
+        // Nothing changed, so nothing is written
+        EXPECT_TRUE(updateFromFingerprint(ro, list, rwPath, built));
+        EXPECT_EQ(readBack(rwPath), rwBlob);
+
+        // A different r/o devtree or list needs a full reinit
+        EXPECT_FALSE(updateFromFingerprint(ro, "X\n", rwPath, built));
+        auto otherRo = built;
+        otherRo.roHash++;
+        EXPECT_FALSE(updateFromFingerprint(ro, list, rwPath, otherRo));
+
+        // A changed attribute that isn't preserved is patched back to
+        // its r/o value, the preserved one is kept
+        auto changed = rwBlob;
+        changed[104] = 0x07;
+        rewrite(rwPath, changed);
+        EXPECT_TRUE(updateFromFingerprint(ro, list, rwPath, built));
+        EXPECT_EQ(readBack(rwPath), rwBlob);
+        {
+            FdtFile rw{rwPath};
+            EXPECT_EQ(getFingerprint(ro, list, rw).rwHash, built.rwHash);
+        }
+
+        // A preserved attribute that doesn't exist can't be kept
+        rewrite(rwPath, changed);
+        {
+            FdtFile rw{rwPath};
+            EXPECT_FALSE(patchDevtree(ro, rw, getPreservedAttrs("ATTR_Z"),
+                                      rwPath));
+        }
+        EXPECT_EQ(readBack(rwPath), changed);
+
+        // A different structure, proc1 has ATTR_X twice, falls back to
+        // a full reinit and leaves the file alone
+        changed[155] = 4;
+        rewrite(rwPath, changed);
+        EXPECT_FALSE(updateFromFingerprint(ro, list, rwPath, built));
+        EXPECT_EQ(readBack(rwPath), changed);
+    }
+
+    std::filesystem::remove(roPath);
+    std::filesystem::remove(rwPath);
+}
+
+TEST(TimingTest, Trace)
+{
+    char dir[] = "/tmp/timingTestXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    {
+        // Not recorded, no procedure is running
+        timing::Span span{"before"};
+    }
+
+    {
+        timing::Procedure procedure{"test", dir};
+        timing::Span outer{"outer"};
+        {
+            timing::Span inner{"inner"};
+        }
+    }
+
+    std::ifstream file{std::filesystem::path{dir} / "test.trace",
+                       std::ios::binary};
+    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>()};
+
+    auto get = [&data](size_t offset, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            value = (value << 8) | data.at(offset + i);
+        }
+        return value;
+    };
+
+    ASSERT_GE(data.size(), 20);
+    EXPECT_EQ(std::string(data.begin(), data.begin() + 4), "PTIM");
+    EXPECT_EQ(data[4], timing::formatVersion);
+    EXPECT_NE(get(8, 8), 0);
+
+    // inner, outer and then the procedure itself
+    ASSERT_EQ(get(16, 4), 3);
+
+    size_t offset = 20;
+    std::vector<std::pair<std::string, uint64_t>> spans;
+    for (int i = 0; i < 3; i++)
+    {
+        auto depth = get(offset + 28, 2);
+        auto length = get(offset + 30, 2);
+        offset += 32;
+        ASSERT_LE(offset + length, data.size());
+        spans.emplace_back(std::string(data.begin() + offset,
+                                       data.begin() + offset + length),
+                           depth);
+        offset += length;
+    }
+    EXPECT_EQ(offset, data.size());
+
+    EXPECT_EQ(spans[0], std::make_pair(std::string("inner"), uint64_t{2}));
+    EXPECT_EQ(spans[1], std::make_pair(std::string("outer"), uint64_t{1}));
+    EXPECT_EQ(spans[2], std::make_pair(std::string("test"), uint64_t{0}));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ClockSamplerTest, Config)
+{
+    using namespace openpower::phal::clock;
+    using namespace std::chrono_literals;
+
+    auto config = loadSamplingConfig("/tmp/clockSamplerTestMissing.json");
+    EXPECT_EQ(config.logPeriod, 24h);
+    EXPECT_TRUE(config.groups.empty());
+
+    std::string text = R"({
+        "logPeriodHours": "0x2",
+        "groups": [
+            {"name": "health", "periodSeconds": 60, "jitterSeconds": 15,
+             "retention": 32, "cfam": ["0x2810", 10299],
+             "i2c": [{"offset": "0xF0", "size": 16}]},
+            {"name": "zero", "periodSeconds": 0},
+            {"name": "range", "periodSeconds": 1,
+             "i2c": [{"offset": "0xF0", "size": 17}]},
+            {"periodSeconds": 1}
+        ]
+    })";
+    auto path = writeTempFile({text.begin(), text.end()});
+
+    config = loadSamplingConfig(path);
+    EXPECT_EQ(config.logPeriod, 2h);
+    ASSERT_EQ(config.groups.size(), 1);
+    EXPECT_EQ(config.groups[0].name, "health");
+    EXPECT_EQ(config.groups[0].period, 60s);
+    EXPECT_EQ(config.groups[0].jitter, 15s);
+    EXPECT_EQ(config.groups[0].retention, 32);
+    EXPECT_EQ(config.groups[0].cfam, (std::vector<uint32_t>{0x2810, 0x283B}));
+    ASSERT_EQ(config.groups[0].i2c.size(), 1);
+    EXPECT_EQ(config.groups[0].i2c[0].offset, 0xF0);
+    EXPECT_EQ(config.groups[0].i2c[0].size, 16);
+    std::filesystem::remove(path);
+
+    // A zero log period keeps the default, the groups are still read
+    text = R"({"logPeriodHours": 0,
+               "groups": [{"name": "health", "periodSeconds": 1}]})";
+    path = writeTempFile({text.begin(), text.end()});
+
+    config = loadSamplingConfig(path);
+    EXPECT_EQ(config.logPeriod, 24h);
+    EXPECT_EQ(config.groups.size(), 1);
+    std::filesystem::remove(path);
+
+    text = "{";
+    path = writeTempFile({text.begin(), text.end()});
+
+    config = loadSamplingConfig(path);
+    EXPECT_EQ(config.logPeriod, 24h);
+    EXPECT_TRUE(config.groups.empty());
+    std::filesystem::remove(path);
+}
+
+TEST(ClockSamplerTest, Schedule)
+{
+    using namespace openpower::phal::clock;
+    using namespace std::chrono_literals;
+
+    std::vector<SampleGroup> groups{{"fast", 10s, 5s, 2, {}, {}},
+                                    {"slow", 60s, 0s, 2, {}, {}}};
+
+    // fast changes on every sample, slow never does
+    std::map<std::string, int> counts;
+    auto collect = [&counts](const SampleGroup& group) {
+        auto count = counts[group.name]++;
+        return std::vector<uint8_t>{
+            static_cast<uint8_t>(group.name == "fast" ? count : 0)};
+    };
+
+    auto start = Sampler::Clock::now();
+    Sampler sampler{groups, start, collect};
+    EXPECT_EQ(sampler.getWakeup(), start);
+
+    sampler.run(start);
+    EXPECT_EQ(counts["fast"], 1);
+    EXPECT_EQ(counts["slow"], 1);
+    EXPECT_EQ(sampler.getWakeup(), start + 15s);
+    EXPECT_TRUE(sampler.takeChanges().empty());
+
+    // Within the jitter, so only fast is due and stays on its period
+    sampler.run(start + 12s);
+    EXPECT_EQ(counts["fast"], 2);
+    EXPECT_EQ(counts["slow"], 1);
+    EXPECT_EQ(sampler.getWakeup(), start + 25s);
+    EXPECT_EQ(sampler.takeChanges(), std::vector<std::string>{"Samples fast"});
+    EXPECT_TRUE(sampler.takeChanges().empty());
+
+    // A whole period behind, so the period restarts now
+    sampler.run(start + 100s);
+    EXPECT_EQ(counts["fast"], 3);
+    EXPECT_EQ(counts["slow"], 2);
+    EXPECT_EQ(sampler.getWakeup(), start + 115s);
+
+    // fast keeps its last two samples, slow only its one distinct one
+    auto sections = sampler.getSections();
+    ASSERT_EQ(sections.size(), 2);
+    EXPECT_EQ(sections[0].subType, openpower::pel::clockSamplesSubType);
+    ASSERT_GE(sections[0].data.size(), 7);
+    EXPECT_EQ(std::string(sections[0].data.begin() + 1,
+                          sections[0].data.begin() + 5),
+              "fast");
+    EXPECT_EQ(sections[0].data[6], 2);
+    EXPECT_EQ(sections[0].data.size(), 7 + (2 * (8 + 4 + 1)));
+    EXPECT_EQ(sections[1].data[6], 1);
+}
+
+TEST(ClockSnapshotTest, SaveAndLoad)
+{
+    using openpower::phal::clock::Snapshot;
+
+    char dir[] = "/tmp/snapshotTestXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    auto path = std::filesystem::path{dir} / "snapshot";
+
+    EXPECT_FALSE(Snapshot::load(path));
+
+    Snapshot snapshot{{{"Proc0", "Functional"}, {"Clock0", ""}},
+                      {{0xCD, 1, {1, 2, 3}}, {0xCE, 2, {}}}};
+    snapshot.setFullLogTime(0x0102030405060708);
+    snapshot.save(path);
+
+    std::ifstream file{path, std::ios::binary};
+    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>()};
+    file.close();
+
+    // header, 2 data entries of 4 byte lengths plus the text, then
+    // 2 sections of 6 bytes plus the data
+    ASSERT_EQ(data.size(), 13 + 4 + (4 + 15) + (4 + 6) + 4 + (6 + 3) + 6);
+    EXPECT_EQ(std::string(data.begin(), data.begin() + 4), "CLKS");
+    EXPECT_EQ(data[5], 0x01);
+    EXPECT_EQ(data[12], 0x08);
+    EXPECT_EQ(data[16], 2);
+
+    auto loaded = Snapshot::load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->getFullLogTime(), 0x0102030405060708);
+    EXPECT_TRUE(loaded->diff(snapshot).empty());
+    EXPECT_TRUE(snapshot.diff(*loaded).empty());
+
+    // Every truncation is rejected
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(data.data()), size);
+        out.close();
+        EXPECT_FALSE(Snapshot::load(path)) << size;
+    }
+
+    // As is a bad magic
+    data[0] = 'X';
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    EXPECT_FALSE(Snapshot::load(path));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ClockSnapshotTest, Diff)
+{
+    using openpower::phal::clock::Snapshot;
+
+    Snapshot before{{{"Proc0", "Functional"}, {"Proc1", "Functional"}},
+                    {{0xCD, 1, {1, 2}}, {0xCD, 1, {3, 4}}}};
+
+    // The order of the additional data doesn't matter
+    Snapshot same{{{"Proc1", "Functional"}, {"Proc0", "Functional"}},
+                  {{0xCD, 1, {1, 2}}, {0xCD, 1, {3, 4}}}};
+    EXPECT_TRUE(same.diff(before).empty());
+
+    Snapshot after{{{"Proc0", "Non Functional"}, {"Clock0", "Functional"}},
+                   {{0xCD, 1, {1, 2}}, {0xCD, 2, {3, 4}}, {0xCE, 1, {}}}};
+    EXPECT_EQ(after.diff(before),
+              (std::vector<std::string>{"Clock0", "Proc0", "Proc1",
+                                        "FFDC section 1", "FFDC section 2"}));
+    EXPECT_EQ(before.diff(after),
+              (std::vector<std::string>{"Proc0", "Proc1", "Clock0",
+                                        "FFDC section 1", "FFDC section 2"}));
 }
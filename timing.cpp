@@ -0,0 +1,187 @@
+#include "timing.hpp"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <phosphor-logging/log.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <mutex>
+
+namespace openpower::util::timing
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+/**
+ * The spans of the procedure being timed
+ */
+struct State
+{
+    std::atomic<bool> active{false};
+    std::mutex mutex;
+    uint64_t start = 0;
+    std::vector<Record> records;
+};
+
+State state;
+
+thread_local uint16_t depth = 0;
+
+uint64_t now(clockid_t clock)
+{
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace
+
+Span::Span(std::string_view name) :
+    active(state.active.load(std::memory_order_relaxed))
+{
+    if (active)
+    {
+        this->name = name;
+        depth++;
+        cpuStart = now(CLOCK_THREAD_CPUTIME_ID);
+        start = now(CLOCK_MONOTONIC);
+    }
+}
+
+Span::~Span()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    auto end = now(CLOCK_MONOTONIC);
+    auto cpu = now(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+    depth--;
+
+    std::lock_guard lock{state.mutex};
+    if (state.active.load(std::memory_order_relaxed) && start >= state.start)
+    {
+        state.records.push_back({std::move(name), start - state.start,
+                                 end - start, cpu,
+                                 static_cast<uint32_t>(syscall(SYS_gettid)),
+                                 static_cast<uint16_t>(depth + 1)});
+    }
+}
+
+Procedure::Procedure(const std::string& name,
+                     const std::filesystem::path& directory) :
+    name(name), directory(directory), realStart(now(CLOCK_REALTIME)),
+    cpuStart(now(CLOCK_PROCESS_CPUTIME_ID))
+{
+    std::lock_guard lock{state.mutex};
+    state.records.clear();
+    state.start = now(CLOCK_MONOTONIC);
+    state.active.store(true, std::memory_order_relaxed);
+}
+
+Procedure::~Procedure()
+{
+    auto end = now(CLOCK_MONOTONIC);
+    auto cpu = now(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+
+    std::vector<Record> records;
+    {
+        std::lock_guard lock{state.mutex};
+        state.active.store(false, std::memory_order_relaxed);
+        records.swap(state.records);
+        records.push_back({name, 0, end - state.start, cpu,
+                           static_cast<uint32_t>(getpid()), 0});
+    }
+
+    const auto& total = records.back();
+
+    // The longest top level phase is usually the one worth looking at
+    const Record* longest = nullptr;
+    for (const auto& record : records)
+    {
+        if ((record.depth == 1) && (!longest || record.wall > longest->wall))
+        {
+            longest = &record;
+        }
+    }
+
+    log<level::INFO>(
+        std::format("Procedure {} took {} ms wall, {} ms CPU, {} spans{}",
+                    name, total.wall / 1000000, total.cpu / 1000000,
+                    records.size() - 1,
+                    longest ? std::format(", longest {} {} ms", longest->name,
+                                          longest->wall / 1000000)
+                            : "")
+            .c_str(),
+        entry("ACTION=%s", name.c_str()),
+        entry("WALL_US=%llu",
+              static_cast<unsigned long long>(total.wall / 1000)),
+        entry("CPU_US=%llu",
+              static_cast<unsigned long long>(total.cpu / 1000)));
+
+    if (directory.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        std::filesystem::create_directories(directory);
+        auto data = serialize(realStart, records);
+        std::ofstream file{directory / (name + ".trace"), std::ios::binary};
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file)
+        {
+            throw std::runtime_error("write failed");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>(std::format("Failed to write {} timing trace ({})",
+                                    name, e.what())
+                            .c_str());
+    }
+}
+
+std::vector<uint8_t> serialize(uint64_t realStart,
+                               const std::vector<Record>& records)
+{
+    std::vector<uint8_t> data;
+
+    auto put = [&data](uint64_t value, size_t size) {
+        for (size_t i = size; i > 0; i--)
+        {
+            data.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+        }
+    };
+
+    data.insert(data.end(), {'P', 'T', 'I', 'M', formatVersion, 0, 0, 0});
+    put(realStart, sizeof(uint64_t));
+    put(records.size(), sizeof(uint32_t));
+
+    for (const auto& record : records)
+    {
+        auto length = std::min<size_t>(record.name.size(), UINT16_MAX);
+        put(record.start, sizeof(uint64_t));
+        put(record.wall, sizeof(uint64_t));
+        put(record.cpu, sizeof(uint64_t));
+        put(record.tid, sizeof(uint32_t));
+        put(record.depth, sizeof(uint16_t));
+        put(length, sizeof(uint16_t));
+        data.insert(data.end(), record.name.begin(),
+                    record.name.begin() + length);
+    }
+
+    return data;
+}
+
+} // namespace openpower::util::timing
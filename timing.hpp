@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openpower::util::timing
+{
+
+/**
+ * The version of the trace file format
+ */
+constexpr uint8_t formatVersion = 1;
+
+/**
+ * @brief One timed span
+ */
+struct Record
+{
+    /** What was timed */
+    std::string name;
+
+    /** Start, nanoseconds after the procedure started */
+    uint64_t start;
+
+    /** Wall time, in nanoseconds */
+    uint64_t wall;
+
+    /** CPU time of the thread, or of the process for the procedure
+     *  itself, in nanoseconds */
+    uint64_t cpu;
+
+    /** Kernel thread id */
+    uint32_t tid;
+
+    /** Nesting depth on the thread, the procedure itself is 0 */
+    uint16_t depth;
+};
+
+/**
+ * @class Span
+ *
+ * Times the scope it lives in, as a sub phase of the procedure being
+ * run by a Procedure.  Spans nest, and can be used from any thread.
+ * Outside of a procedure, for example in the other services that share
+ * this code, a span records nothing and costs one atomic load.
+ */
+class Span
+{
+  public:
+    Span() = delete;
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+    Span(Span&&) = delete;
+    Span& operator=(Span&&) = delete;
+
+    /**
+     * Constructor.
+     *
+     * @param[in] name - what is being timed, for example "phal_init"
+     */
+    explicit Span(std::string_view name);
+
+    /**
+     * Destructor.
+     *
+     * Records the span.
+     */
+    ~Span();
+
+  private:
+    /** If a procedure was being timed when the span started */
+    bool active;
+
+    /** The span name */
+    std::string name;
+
+    /** Monotonic start time */
+    uint64_t start = 0;
+
+    /** Thread CPU time at the start */
+    uint64_t cpuStart = 0;
+};
+
+/**
+ * @class Procedure
+ *
+ * Times a procedure run, collecting the spans inside it.  When it goes
+ * out of scope it writes them to <directory>/<procedure>.trace and logs
+ * a one line summary to the journal.
+ *
+ * tools/proc-timing-to-chrome.py converts the trace file to the Chrome
+ * trace event JSON format, for chrome://tracing or Perfetto.
+ */
+class Procedure
+{
+  public:
+    Procedure() = delete;
+    Procedure(const Procedure&) = delete;
+    Procedure& operator=(const Procedure&) = delete;
+    Procedure(Procedure&&) = delete;
+    Procedure& operator=(Procedure&&) = delete;
+
+    /**
+     * Constructor.
+     *
+     * Starts timing.  Only one procedure can be timed at a time.
+     *
+     * @param[in] name - the procedure name
+     * @param[in] directory - where to write the trace file, nothing is
+     *                        written if empty
+     */
+    Procedure(const std::string& name, const std::filesystem::path& directory);
+
+    /**
+     * Destructor.
+     *
+     * Stops timing, writes the trace file and logs the summary.
+     * Failures are logged, never thrown.
+     */
+    ~Procedure();
+
+  private:
+    /** The procedure name */
+    std::string name;
+
+    /** The trace file directory */
+    std::filesystem::path directory;
+
+    /** Wall clock start time */
+    uint64_t realStart;
+
+    /** Process CPU time at the start */
+    uint64_t cpuStart;
+};
+
+/**
+ * @brief Serialize records into the trace file format, all big endian:
+ *
+ *   char magic[4]      "PTIM"
+ *   uint8 version      formatVersion
+ *   uint8 reserved
+ *   uint16 reserved
+ *   uint64 start       wall clock start, nanoseconds since the epoch
+ *   uint32 count       the number of records that follow
+ * then for each record, in the order they finished:
+ *   uint64 start, uint64 wall, uint64 cpu
+ *   uint32 tid
+ *   uint16 depth
+ *   uint16 length
+ *   char name[length]  not NUL terminated
+ *
+ * @param[in] realStart - wall clock start time
+ * @param[in] records - the records
+ *
+ * @return the serialized records
+ */
+std::vector<uint8_t> serialize(uint64_t realStart,
+                               const std::vector<Record>& records);
+
+} // namespace openpower::util::timing
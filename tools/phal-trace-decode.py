@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+
+"""
+Decodes the binary PHAL trace FFDC section (sub type 0xCC) that
+openpower-proc-control adds to PHAL PELs.  The section is read from
+the file named on the command line, or from stdin, and the traces
+are printed oldest first, one per line.
+
+The format is described with TraceBuffer::serialize() in
+extensions/phal/trace_buffer.hpp.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+MAGIC = b"PTRC"
+VERSION = 1
+HEADER = struct.Struct(">4sBxH")
+RECORD = struct.Struct(">IQH")
+
+
+def decode(data):
+    """Returns a list of (number, time, text), oldest first"""
+    if len(data) < HEADER.size:
+        raise ValueError("section is too short")
+
+    magic, version, count = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError(f"bad magic {magic!r}")
+    if version != VERSION:
+        raise ValueError(f"unsupported version {version}")
+
+    lines = []
+    offset = HEADER.size
+    for _ in range(count):
+        if offset + RECORD.size > len(data):
+            break
+        number, seconds, length = RECORD.unpack_from(data, offset)
+        offset += RECORD.size
+        # The PEL may have trimmed the end of the section
+        text = data[offset : offset + length]
+        offset += length
+        lines.append((number, seconds, text.decode("utf-8", "replace")))
+
+    return sorted(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument(
+        "file", nargs="?", help="the raw FFDC section, stdin if not given"
+    )
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    try:
+        lines = decode(data)
+    except ValueError as e:
+        sys.exit(f"{args.file or 'stdin'}: {e}")
+
+    for number, seconds, text in lines:
+        stamp = time.strftime("%Y-%m-%d %H:%M:%S", time.gmtime(seconds))
+        print(f"LOG{number:03} {stamp} {text}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+"""
+Converts a procedure timing trace, written by openpower-proc-control
+for every procedure it runs, to the Chrome trace event JSON format
+so it can be viewed in chrome://tracing or https://ui.perfetto.dev.
+The trace is read from the file named on the command line, or from
+stdin, and the JSON is written to stdout.
+
+The format is described with serialize() in timing.hpp.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"PTIM"
+VERSION = 1
+HEADER = struct.Struct(">4sBxxxQI")
+RECORD = struct.Struct(">QQQIHH")
+
+
+def decode(data):
+    """Returns (start, [(name, start, wall, cpu, tid, depth)]), all in
+    nanoseconds, the span starts relative to the procedure start"""
+    if len(data) < HEADER.size:
+        raise ValueError("trace is too short")
+
+    magic, version, start, count = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError(f"bad magic {magic!r}")
+    if version != VERSION:
+        raise ValueError(f"unsupported version {version}")
+
+    spans = []
+    offset = HEADER.size
+    for _ in range(count):
+        if offset + RECORD.size > len(data):
+            raise ValueError("trace is truncated")
+        begin, wall, cpu, tid, depth, length = RECORD.unpack_from(
+            data, offset
+        )
+        offset += RECORD.size
+        name = data[offset : offset + length].decode("utf-8", "replace")
+        offset += length
+        spans.append((name, begin, wall, cpu, tid, depth))
+
+    return start, spans
+
+
+def to_chrome(start, spans):
+    """Returns the spans as a Chrome trace event JSON object"""
+    events = []
+    for name, begin, wall, cpu, tid, depth in spans:
+        events.append(
+            {
+                "name": name,
+                "cat": "procedure" if depth == 0 else "span",
+                "ph": "X",
+                "ts": begin / 1000,
+                "dur": wall / 1000,
+                "tdur": cpu / 1000,
+                "pid": 0,
+                "tid": tid,
+                "args": {"cpu_ms": cpu / 1000000},
+            }
+        )
+
+    # Chrome nests complete events by start time, so parents go first
+    events.sort(key=lambda e: (e["ts"], -e["dur"]))
+
+    return {
+        "traceEvents": events,
+        "displayTimeUnit": "ms",
+        "otherData": {"start_ns": start},
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument(
+        "file", nargs="?", help="the .trace file, stdin if not given"
+    )
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    try:
+        start, spans = decode(data)
+    except ValueError as e:
+        sys.exit(f"{args.file or 'stdin'}: {e}")
+
+    json.dump(to_chrome(start, spans), sys.stdout, indent=1)
+    print()
+
+
+if __name__ == "__main__":
+    main()
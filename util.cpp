@@ -1,9 +1,18 @@
 #include "util.hpp"
 
+#include "timing.hpp"
+
+#include <unistd.h>
+
 #include <phosphor-logging/elog.hpp>
+#include <sdbusplus/bus/match.hpp>
 
 #include <format>
+#include <map>
+#include <memory>
 #include <sstream>
+#include <tuple>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -13,20 +22,143 @@ namespace util
 {
 using namespace phosphor::logging;
 
-std::string getService(sdbusplus::bus_t& bus, const std::string& objectPath,
+/**
+ * The D-Bus connection and service name cache used by one thread
+ */
+class BusContext
+{
+  public:
+    BusContext(const BusContext&) = delete;
+    BusContext& operator=(const BusContext&) = delete;
+    BusContext(BusContext&&) = delete;
+    BusContext& operator=(BusContext&&) = delete;
+    ~BusContext() = default;
+
+    BusContext() : bus(sdbusplus::bus::new_bus()) {}
+
+    /**
+     * The connection.  It is private to this thread, so nothing
+     * else dispatches the messages queued on it.
+     */
+    sdbusplus::bus_t bus;
+
+    /**
+     * The service names found so far, by (object path, interface)
+     */
+    std::map<std::pair<std::string, std::string>, std::string> services;
+
+    /**
+     * Caches a service, and watches its well known name so that it
+     * is forgotten when the name is released or taken over.  Only the
+     * cached names are matched, so that the connection doesn't queue
+     * every NameOwnerChanged signal on the bus.
+     *
+     * @param[in] key - the (object path, interface)
+     * @param[in] name - the service name
+     */
+    void addService(std::pair<std::string, std::string>&& key,
+                    const std::string& name)
+    {
+        if (!ownerChanged.contains(name))
+        {
+            ownerChanged.emplace(
+                std::piecewise_construct, std::forward_as_tuple(name),
+                std::forward_as_tuple(
+                    bus, sdbusplus::bus::match::rules::nameOwnerChanged(name),
+                    [this](auto& msg) { nameOwnerChanged(msg); }));
+        }
+
+        services.emplace(std::move(key), name);
+    }
+
+  private:
+    /**
+     * Forgets the cached services of a well known name that was
+     * released or taken over.
+     *
+     * @param[in] msg - the NameOwnerChanged signal
+     */
+    void nameOwnerChanged(sdbusplus::message_t& msg)
+    {
+        std::string name;
+        std::string oldOwner;
+        std::string newOwner;
+        msg.read(name, oldOwner, newOwner);
+
+        std::erase_if(services,
+                      [&name](const auto& s) { return s.second == name; });
+    }
+
+    /**
+     * The matches for NameOwnerChanged signals, by cached name
+     */
+    std::map<std::string, sdbusplus::bus::match_t> ownerChanged;
+};
+
+/**
+ * Returns the calling thread's BusContext, creating it on first use.
+ * A forked child gets its own, as sd-bus connections can't be used
+ * across a fork.
+ */
+static BusContext& getContext()
+{
+    static thread_local std::unique_ptr<BusContext> context;
+    static thread_local pid_t owner = 0;
+
+    if (!context || (owner != getpid()))
+    {
+        // Freeing the parent's context in the child would try to use
+        // its connection, so it is left alone.
+        static_cast<void>(context.release());
+        context = std::make_unique<BusContext>();
+        owner = getpid();
+    }
+
+    return *context;
+}
+
+sdbusplus::bus_t& getBus()
+{
+    return getContext().bus;
+}
+
+std::string getService(const std::string& objectPath,
                        const std::string& interface)
 {
     constexpr auto mapperBusBame = "xyz.openbmc_project.ObjectMapper";
     constexpr auto mapperObjectPath = "/xyz/openbmc_project/object_mapper";
     constexpr auto mapperInterface = "xyz.openbmc_project.ObjectMapper";
+
+    auto& context = getContext();
+    auto& bus = context.bus;
+
     std::vector<std::pair<std::string, std::vector<std::string>>> response;
-    auto method = bus.new_method_call(mapperBusBame, mapperObjectPath,
-                                      mapperInterface, "GetObject");
-    method.append(objectPath, std::vector<std::string>({interface}));
     try
     {
+        // Handle any NameOwnerChanged signals received since the last
+        // call, so a stale service isn't returned.
+        while (sd_bus_process(bus.get(), nullptr) > 0)
+        {}
+
+        auto key = std::make_pair(objectPath, interface);
+        if (auto service = context.services.find(key);
+            service != context.services.end())
+        {
+            return service->second;
+        }
+
+        auto method = bus.new_method_call(mapperBusBame, mapperObjectPath,
+                                          mapperInterface, "GetObject");
+        method.append(objectPath, std::vector<std::string>({interface}));
+
+        timing::Span span{"D-Bus GetObject"};
         auto reply = bus.call(method);
         reply.read(response);
+
+        if (!response.empty())
+        {
+            context.addService(std::move(key), response.begin()->first);
+        }
     }
     catch (const sdbusplus::exception_t& e)
     {
@@ -53,13 +185,14 @@ bool isHostPoweringOff()
         constexpr auto service = "xyz.openbmc_project.State.Host";
         constexpr auto interface = "xyz.openbmc_project.State.Host";
         constexpr auto property = "CurrentHostState";
-        auto bus = sdbusplus::bus::new_default();
+        auto& bus = getBus();
 
         std::variant<std::string> retval;
         auto properties = bus.new_method_call(
             service, object, "org.freedesktop.DBus.Properties", "Get");
         properties.append(interface);
         properties.append(property);
+        timing::Span span{"D-Bus Get CurrentHostState"};
         auto result = bus.call(properties);
         result.read(retval);
 
@@ -96,13 +229,14 @@ std::string getChassisPowerState()
     std::string powerState{};
     try
     {
-        auto bus = sdbusplus::bus::new_default();
+        auto& bus = getBus();
         auto properties =
             bus.new_method_call("xyz.openbmc_project.State.Chassis0",
                                 "/xyz/openbmc_project/state/chassis0",
                                 "org.freedesktop.DBus.Properties", "Get");
         properties.append("xyz.openbmc_project.State.Chassis");
         properties.append("CurrentPowerState");
+        timing::Span span{"D-Bus Get CurrentPowerState"};
         auto result = bus.call(properties);
         auto val = result.unpack<std::variant<std::string>>();
 
@@ -8,16 +8,29 @@ namespace openpower
 {
 namespace util
 {
+/**
+ * Returns the D-Bus connection shared by everything running on the
+ * calling thread.  Each thread gets its own connection, as sd-bus
+ * connections can't be used from more than one thread, and so does
+ * a forked child process.
+ *
+ * @return the D-Bus connection, exception on failure
+ */
+sdbusplus::bus_t& getBus();
+
 /**
  * Get D-Bus service name for the specified object and interface
  *
- * @param[in] bus - sdbusplus D-Bus to attach to
+ * The mapper is only asked the first time; after that the answer
+ * comes from a per-thread cache, which forgets a service when its
+ * name changes owner.
+ *
  * @param[in] objectPath - D-Bus object path
  * @param[in] interface - D-Bus interface name
  *
  * @return service name on success and exception on failure
  */
-std::string getService(sdbusplus::bus_t& bus, const std::string& objectPath,
+std::string getService(const std::string& objectPath,
                        const std::string& interface);
 
 /**